@@ -18,23 +18,33 @@ SOURCES += main.cpp \
     modems/modemrtty.cpp \
     modems/modemrttyconfig.cpp \
     modems/modemtransmitter.cpp \
+    signalprocessing/bandpower.cpp \
+    signalprocessing/builtinfftbackend.cpp \
+    signalprocessing/fftbackend.cpp \
     signalprocessing/fftfilter.cpp \
+    signalprocessing/fftfilterbank.cpp \
+    signalprocessing/fftplancache.cpp \
     signalprocessing/fftspectrum.cpp \
     signalprocessing/fftspectrumworker.cpp \
     signalprocessing/filters.cpp \
     signalprocessing/misc.cpp \
+    signalprocessing/nco.cpp \
     audio/audioconsumer.cpp \
     audio/audioconsumerlist.cpp \
     audio/audiodevice.cpp \
     audio/audiodevicein.cpp \
+    audio/audiodeviceinfile.cpp \
+    audio/audiodeviceinfilethread.cpp \
     audio/audiodeviceinthread.cpp \
     audio/audiodevicelist.cpp \
     audio/audiodeviceout.cpp \
+    audio/audiodeviceoutfile.cpp \
+    audio/audiodeviceoutfilethread.cpp \
     audio/audiodeviceoutthread.cpp \
+    audio/audiopcmconverter.cpp \
     audio/audioproducer.cpp \
     audio/audioproducerlist.cpp \
-    audio/audioringbuffer.cpp \
-    audio/circularbuffer.cpp \
+    audio/wavfile.cpp \
     modems/modemreceiver.cpp \
     transmittertextedit.cpp
 
@@ -46,23 +56,34 @@ HEADERS  += mainwindow.h \
     modems/modemrtty.h \
     modems/modemrttyconfig.h \
     modems/modemtransmitter.h \
+    signalprocessing/bandpower.h \
+    signalprocessing/builtinfftbackend.h \
+    signalprocessing/fftbackend.h \
     signalprocessing/fftfilter.h \
+    signalprocessing/fftfilterbank.h \
+    signalprocessing/fftplancache.h \
     signalprocessing/fftspectrum.h \
     signalprocessing/fftspectrumworker.h \
     signalprocessing/filters.h \
     signalprocessing/misc.h \
+    signalprocessing/nco.h \
     audio/audioconsumer.h \
     audio/audioconsumerlist.h \
     audio/audiodevice.h \
     audio/audiodevicein.h \
+    audio/audiodeviceinfile.h \
+    audio/audiodeviceinfilethread.h \
     audio/audiodeviceinthread.h \
     audio/audiodevicelist.h \
     audio/audiodeviceout.h \
+    audio/audiodeviceoutfile.h \
+    audio/audiodeviceoutfilethread.h \
     audio/audiodeviceoutthread.h \
+    audio/audiopcmconverter.h \
     audio/audioproducer.h \
     audio/audioproducerlist.h \
-    audio/audioringbuffer.h \
-    audio/circularbuffer.h \
+    audio/lockfreeringbuffer.h \
+    audio/wavfile.h \
     modems/modemreceiver.h \
     transmittertextedit.h
 
@@ -70,6 +91,14 @@ FORMS    += mainwindow.ui
 
 INCLUDEPATH += external/include
 
-LIBS += $$_PRO_FILE_PWD_/external/bin/libfftw3-3.dll
+# FFTW is the default FFT backend, CONFIG+=builtin_fft builds without it. On Windows the
+# bundled library is linked, elsewhere the one of the system.
+!builtin_fft {
+    DEFINES += HAVE_FFTW
+    SOURCES += signalprocessing/fftwbackend.cpp
+    HEADERS += signalprocessing/fftwbackend.h
+    win32: LIBS += $$_PRO_FILE_PWD_/external/bin/libfftw3-3.dll
+    else: LIBS += -lfftw3
+}
 
 #DEFINES += _USE_MATH_DEFINES
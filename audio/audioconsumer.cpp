@@ -33,10 +33,14 @@ AudioConsumer::AudioConsumer(QObject* parent, qint64 samples)
       m_samples(samples),
       m_thread(0),
       m_terminate(false),
-      m_dataReady(false),
-      m_position(0)
+      m_queueDepth(0),
+      m_queueHead(0),
+      m_queueCount(0),
+      m_overruns(0),
+      m_queueHighWater(0)
 {
     setNumSamples(samples);
+    setQueueDepth(8);
 
     m_thread = new QThread(parent);
     moveToThread(m_thread);
@@ -50,6 +54,7 @@ AudioConsumer::~AudioConsumer()
     m_waitMutex.lock();
     m_terminate = true;
     m_waitCond.wakeAll();
+    m_queueCond.wakeAll();
     m_waitMutex.unlock();
     m_thread->quit();
     m_thread->wait();
@@ -60,11 +65,6 @@ void AudioConsumer::setNumSamples(qint64 samples)
 {
     m_waitMutex.lock();
     m_samples = samples;
-    m_position = 0;
-    m_buffer.resize(m_samples);
-    m_buffer.fill(0);
-    m_data.resize(m_samples);
-    m_data.fill(0);
     m_waitMutex.unlock();
 }
 
@@ -73,73 +73,110 @@ qint64 AudioConsumer::getNumSamples() const
     return m_samples;
 }
 
-void AudioConsumer::create(QAudioFormat format)
+/**
+ * @brief Sets the number of blocks that can be queued while the processing thread is busy
+ */
+void AudioConsumer::setQueueDepth(int depth)
 {
-    m_format = format;
+    if (depth < 1)
+        depth = 1;
+
+    QMutexLocker lock(&m_waitMutex);
+
+    // keep the oldest blocks that fit into the new queue
+    QVector<QVector<double> > queue(depth);
+    int count = qMin(m_queueCount, depth);
+    for (int i = 0; i < count; i++)
+        queue[i] = m_queue[(m_queueHead + i) % m_queueDepth];
+    m_overruns += m_queueCount - count;
+
+    m_queue = queue;
+    m_queueDepth = depth;
+    m_queueHead = 0;
+    m_queueCount = count;
 }
 
-const QAudioFormat& AudioConsumer::getFormat() const
+int AudioConsumer::getQueueDepth() const
 {
-    return m_format;
+    return m_queueDepth;
 }
 
-qint64 AudioConsumer::writeData(const char* data, qint64 len)
+qint64 AudioConsumer::getOverruns() const
 {
-    const int bytesPerSample = (getFormat().sampleSize() / 8) * getFormat().channelCount();
-
-    if (getFormat().isValid()) {
-        qint64 bytesWrittenTotal = 0;
+    return m_overruns;
+}
 
-        // signal that a block of data is available as soon as the buffer is full
-        qint64 bytesLeft = len;
-        do {
-            qreal pcmSample = AudioDevice::pcmToReal(getFormat(), data + bytesWrittenTotal);
-            m_buffer[m_position] = pcmSample;
-            m_position++;
+int AudioConsumer::getQueueHighWater() const
+{
+    return m_queueHighWater;
+}
 
-            // the buffer is full, convert the data block into real data
-            if (m_position == m_buffer.size()) {
-                m_position = 0;
+void AudioConsumer::resetStatistics()
+{
+    QMutexLocker lock(&m_waitMutex);
+    m_overruns = 0;
+    m_queueHighWater = m_queueCount;
+}
 
-                // If a complete chunk of data has been written, see if the worker thread can already process new data and
-                // copy from m_buffer to m_data. If the worker thread is still computing, don't copy data and continue. This will
-                // overwrite previous data.
-                if (m_waitMutex.tryLock()) {
-                    // copy data from buffer
-                    memcpy((void*)m_data.data(), (void*)m_buffer.data(), m_buffer.size() * sizeof(double));
-                    m_dataReady = true;
-                    m_waitMutex.unlock();
+void AudioConsumer::create(QAudioFormat format)
+{
+    m_format = format;
+}
 
-                    // signal that new data is available
-                    m_waitCond.wakeAll();
-                }
-            }
+const QAudioFormat& AudioConsumer::getFormat() const
+{
+    return m_format;
+}
 
-            bytesWrittenTotal += bytesPerSample;
-            bytesLeft -= bytesPerSample;
-        } while (bytesLeft > 0);
+/**
+ * @brief Queues a block for the processing thread
+ * @param block the shared block
+ * @param wait if true, wait until the queue has room for the block instead of dropping it
+ */
+void AudioConsumer::writeBlock(const QVector<double>& block, bool wait)
+{
+    // The processing thread only holds the lock while taking a block from the queue, so this
+    // does not wait for the processing of the previous block.
+    m_waitMutex.lock();
+    while (wait && m_queueCount == m_queueDepth && !m_terminate)
+        m_queueCond.wait(&m_waitMutex);
 
-        return bytesWrittenTotal;
+    if (m_queueCount == m_queueDepth) {
+        m_overruns++;
+        m_waitMutex.unlock();
+        return;
     }
 
-    return 0;
+    // take a reference to the shared block
+    m_queue[(m_queueHead + m_queueCount) % m_queueDepth] = block;
+    m_queueCount++;
+    m_queueHighWater = qMax(m_queueHighWater, m_queueCount);
+    m_waitMutex.unlock();
+
+    // signal that new data is available
+    m_waitCond.wakeAll();
 }
 
 void AudioConsumer::processThread()
 {
     forever {
         QMutexLocker lock(&m_waitMutex);
-        while (!m_dataReady && !m_terminate)
+        while (m_queueCount == 0 && !m_terminate)
             m_waitCond.wait(&m_waitMutex);
 
         if (m_terminate)
             break;
 
-        // process audio data
-        processAudio(m_data);
-
-        m_dataReady = false;
+        // take the next block and free its slot
+        QVector<double> block = m_queue[m_queueHead];
+        m_queue[m_queueHead] = QVector<double>();
+        m_queueHead = (m_queueHead + 1) % m_queueDepth;
+        m_queueCount--;
         lock.unlock();
+        m_queueCond.wakeAll();
+
+        // process audio data, the shared block is released afterwards
+        processAudio(block);
     }
 }
 
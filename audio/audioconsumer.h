@@ -43,6 +43,11 @@ class AudioConsumerList;
  * input consumer and the actual audio device. Any module that needs to process
  * input audio data is a subclass of AudioConsumer and registers itself to the
  * input device.
+ *
+ * Blocks are passed from the audio thread to the processing thread through a bounded queue.
+ * If the processing thread is busy for a while, blocks are queued which adds latency instead
+ * of losing samples. A block is only dropped if the queue is full, which is counted as an
+ * overrun. Sources that are not paced by hardware can wait for a free slot instead.
  */
 class AudioConsumer
         : public QObject
@@ -59,7 +64,11 @@ public:
     void setNumSamples(qint64);
     qint64 getNumSamples() const;
 
-    qint64 writeData(const char* data, qint64 len);
+    void setQueueDepth(int);
+    int getQueueDepth() const;
+    qint64 getOverruns() const;
+    int getQueueHighWater() const;
+    void resetStatistics();
 
     virtual void start();
     virtual void stop();
@@ -77,7 +86,8 @@ protected:
 
     /**
      * @brief Is called in a separate thread when the next block of continous frames is available
-     * @param data the audio data block containing m_frames audio frames
+     * @param data the audio data block containing m_frames audio frames. The block is shared
+     * with the other consumers and must not be modified.
      */
     virtual void processAudio(const QVector<double>& data) = 0;
 
@@ -85,16 +95,21 @@ private slots:
     void processThread();
 
 private:
+    void writeBlock(const QVector<double>& block, bool wait);
+
     QAudioFormat    m_format;
     qint64          m_samples;
     QWaitCondition  m_waitCond;
+    QWaitCondition  m_queueCond;    // signalled when a slot in the queue has been freed
     QMutex          m_waitMutex;
     QThread*        m_thread;
     bool            m_terminate;
-    bool            m_dataReady;
-    int             m_position;
-    QVector<double> m_data;     // the data that is sent to the consumer
-    QVector<double> m_buffer;   // the buffer that gets written to
+    QVector<QVector<double> > m_queue;  // queued shared blocks, m_queueDepth slots
+    int             m_queueDepth;
+    int             m_queueHead;    // the next block to process
+    int             m_queueCount;
+    qint64          m_overruns;     // number of blocks dropped because the queue was full
+    int             m_queueHighWater;
 };
 
 } // namespace Internal
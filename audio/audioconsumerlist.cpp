@@ -32,7 +32,8 @@ using namespace Digital::Internal;
 
 AudioConsumerList::AudioConsumerList(AudioDeviceIn* device)
     : QIODevice(device),
-      m_device(device)
+      m_device(device),
+      m_blocking(false)
 {
 }
 
@@ -40,6 +41,21 @@ AudioConsumerList::~AudioConsumerList()
 {
 }
 
+void AudioConsumerList::create(const QAudioFormat& format)
+{
+    m_converter.setFormat(format);
+}
+
+void AudioConsumerList::setBlocking(bool blocking)
+{
+    m_blocking = blocking;
+}
+
+bool AudioConsumerList::isBlocking() const
+{
+    return m_blocking;
+}
+
 bool AudioConsumerList::add(AudioConsumer* consumer)
 {
     if (!consumer)
@@ -89,14 +105,97 @@ void AudioConsumerList::stopSoundcard()
 
 qint64 AudioConsumerList::writeData(const char* data, qint64 len)
 {
-    // write data into each registered audio consumer
-    qint64 bytesWritten = 0;
+    if (!m_converter.isValid())
+        return 0;
+
+    // convert the period only once
+    const int bytesPerFrame = m_converter.getBytesPerFrame();
+    const qint64 frames = len / bytesPerFrame;
+    if (m_samples.size() < frames)
+        m_samples.resize(frames);
+
+    m_converter.convert(data, frames, m_samples.data());
+
+    // collect the samples into blocks and hand each finished block to all consumers that use
+    // this block size
+    updateStreams();
+
+    QHash<qint64, BlockStream>::iterator it;
+    for (it = m_streams.begin(); it != m_streams.end(); ++it) {
+        const qint64 blockSize = it.key();
+        BlockStream& stream = it.value();
+
+        qint64 samplesWritten = 0;
+        while (samplesWritten < frames) {
+            qint64 count = qMin(frames - samplesWritten, blockSize - stream.position);
+            memcpy(stream.block.data() + stream.position, m_samples.constData() + samplesWritten,
+                   count * sizeof(double));
+            stream.position += count;
+            samplesWritten += count;
+
+            if (stream.position == blockSize) {
+                foreach (AudioConsumer* consumer, m_consumerList) {
+                    if (consumer->getNumSamples() == blockSize)
+                        consumer->writeBlock(stream.block, m_blocking);
+                }
+
+                nextBlock(blockSize, stream);
+            }
+        }
+    }
+
+    return frames * bytesPerFrame;
+}
+
+void AudioConsumerList::updateStreams()
+{
+    // create streams for new block sizes, with enough blocks to fill the consumer queues
     foreach (AudioConsumer* consumer, m_consumerList) {
-        qint64 written = consumer->writeData(data, len);
-        bytesWritten = qMax(bytesWritten, written);
+        const qint64 blockSize = consumer->getNumSamples();
+        if (blockSize > 0 && !m_streams.contains(blockSize)) {
+            BlockStream& stream = m_streams[blockSize];
+            for (int i = 0; i < consumer->getQueueDepth() + 1; i++)
+                stream.pool.append(QVector<double>(blockSize));
+
+            nextBlock(blockSize, stream);
+        }
+    }
+
+    // remove streams that are not used by any consumer anymore
+    QHash<qint64, BlockStream>::iterator it = m_streams.begin();
+    while (it != m_streams.end()) {
+        bool used = false;
+        foreach (AudioConsumer* consumer, m_consumerList) {
+            if (consumer->getNumSamples() == it.key()) {
+                used = true;
+                break;
+            }
+        }
+
+        if (used)
+            ++it;
+        else
+            it = m_streams.erase(it);
+    }
+}
+
+void AudioConsumerList::nextBlock(qint64 blockSize, BlockStream& stream)
+{
+    // the current block is now owned by the consumers, keep a reference to reuse it later
+    if (!stream.block.isEmpty())
+        stream.pool.append(stream.block);
+
+    stream.position = 0;
+
+    // reuse a block that has been released by all consumers
+    for (int i = 0; i < stream.pool.size(); i++) {
+        if (stream.pool[i].isDetached()) {
+            stream.block = stream.pool.takeAt(i);
+            return;
+        }
     }
 
-    return bytesWritten;
+    stream.block = QVector<double>(blockSize);
 }
 
 qint64 AudioConsumerList::readData(char* data, qint64 maxlen)
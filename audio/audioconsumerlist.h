@@ -26,6 +26,9 @@
 #define AUDIOCONSUMERLIST_H
 
 #include <QIODevice>
+#include <QVector>
+#include <QHash>
+#include "audiopcmconverter.h"
 
 namespace Digital {
 namespace Internal {
@@ -38,6 +41,15 @@ class AudioDeviceIn;
  * QAudioInput. Any class that is derived from AudioConsumer can register itself to the
  * consumer list and will from now on receive data based on the consumer specialization
  * (i.e. continous data or latest data).
+ *
+ * Each period is converted only once. The samples are collected into blocks of the size
+ * requested by the consumers and the same block is handed to every consumer with that block
+ * size. Blocks are implicitly shared and never modified after they have been handed out, so
+ * consumers only hold references instead of private copies.
+ *
+ * By default a block is dropped for a consumer whose queue is full, so a slow consumer never
+ * stalls the soundcard. In blocking mode the writer waits for the consumers instead, which
+ * is used by sources that can deliver data faster than real time.
  */
 class AudioConsumerList
         : public QIODevice
@@ -46,6 +58,11 @@ public:
     AudioConsumerList(AudioDeviceIn* device);
     ~AudioConsumerList();
 
+    void create(const QAudioFormat&);
+
+    void setBlocking(bool);
+    bool isBlocking() const;
+
     bool add(AudioConsumer*);
     bool remove(AudioConsumer*);
 
@@ -58,8 +75,24 @@ protected:
     qint64 readData(char* data, qint64 maxlen);
 
 private:
+    struct BlockStream
+    {
+        BlockStream() : position(0) {}
+
+        QVector<double> block;          // the block that is currently filled
+        QList<QVector<double> > pool;   // blocks that have been handed out before
+        qint64 position;
+    };
+
+    void updateStreams();
+    void nextBlock(qint64 blockSize, BlockStream& stream);
+
     AudioDeviceIn* m_device;
     QList<AudioConsumer*> m_consumerList;
+    AudioPcmConverter m_converter;
+    bool m_blocking;
+    QVector<double> m_samples;
+    QHash<qint64, BlockStream> m_streams;   // one stream per distinct consumer block size
 };
 
 } // namespace Internal
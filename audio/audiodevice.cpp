@@ -57,6 +57,11 @@ const QString& AudioDevice::getDeviceName() const
     return m_deviceName;
 }
 
+void AudioDevice::setDeviceName(const QString& deviceName)
+{
+    m_deviceName = deviceName;
+}
+
 void AudioDevice::setFormat(QAudioFormat format)
 {
     m_format = format;
@@ -112,9 +117,24 @@ int AudioDevice::getFrameSize() const
     return (m_format.sampleSize() / 8) * m_format.channelCount();
 }
 
+/**
+ * @brief Sets 8 kHz mono 16 bit PCM for devices that do not provide a preferred format
+ */
+void AudioDevice::setDefaultFormat()
+{
+    m_format = QAudioFormat();
+    m_format.setCodec("audio/pcm");
+    m_format.setByteOrder(QAudioFormat::LittleEndian);
+    m_format.setSampleType(QAudioFormat::SignedInt);
+    m_format.setSampleRate(8000);
+    m_format.setSampleSize(16);
+    m_format.setChannelCount(1);
+}
+
 bool AudioDevice::init()
 {
-    if (!m_deviceInfo.isFormatSupported(m_format)) {
+    // devices without audio hardware (e.g. files) accept any format
+    if (!m_deviceInfo.isNull() && !m_deviceInfo.isFormatSupported(m_format)) {
         qWarning() << "format not supported, choosing nearest format.";
         m_format = m_deviceInfo.nearestFormat(m_format);
     }
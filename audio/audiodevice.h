@@ -80,6 +80,9 @@ signals:
 protected:
     AudioDevice(QObject* parent, QAudioDeviceInfo deviceInfo);
 
+    void setDeviceName(const QString&);
+    void setDefaultFormat();
+
     virtual bool iInit(const QAudioDeviceInfo&) = 0;
     virtual bool iClose() = 0;
 
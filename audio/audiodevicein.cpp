@@ -49,6 +49,8 @@ bool AudioDeviceIn::iInit(const QAudioDeviceInfo& info)
 {
     close();
 
+    m_consumerList->create(getFormat());
+
     m_thread = new AudioDeviceInThread(info, getFormat(), m_consumerList);
     connect(this, &AudioDeviceIn::startAudio, m_thread, &AudioDeviceInThread::startAudio);
     connect(this, &AudioDeviceIn::stopAudio, m_thread, &AudioDeviceInThread::stopAudio);
@@ -68,6 +70,11 @@ bool AudioDeviceIn::iClose()
     return true;
 }
 
+AudioConsumerList* AudioDeviceIn::getConsumerList() const
+{
+    return m_consumerList;
+}
+
 bool AudioDeviceIn::start()
 {
     if (m_thread && m_thread->isStarted()) {
@@ -106,9 +113,12 @@ qint32 AudioDeviceIn::getBufferSize() const
 
 bool AudioDeviceIn::registerConsumer(AudioConsumer* consumer)
 {
-    if (m_consumerList->add(consumer)) {
-        consumer->create(getFormat());
+    if (!consumer)
+        return false;
 
+    // registered() may already use the format
+    consumer->create(getFormat());
+    if (m_consumerList->add(consumer)) {
         //connect(consumer, SIGNAL(destroyed()), this, SLOT(unregisterConsumer(AudioConsumer*)));
 
         return true;
@@ -66,6 +66,8 @@ protected:
     bool iInit(const QAudioDeviceInfo&);
     bool iClose();
 
+    AudioConsumerList* getConsumerList() const;
+
 private:
     QMutex                  m_initMutex;
     QWaitCondition          m_initCond;
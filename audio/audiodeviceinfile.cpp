@@ -0,0 +1,135 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "audiodeviceinfile.h"
+#include "audiodeviceinfilethread.h"
+#include "audioconsumerlist.h"
+#include "wavfile.h"
+#include <QFileInfo>
+#include <QDebug>
+
+using namespace Digital::Internal;
+
+AudioDeviceInFile::AudioDeviceInFile(QObject* parent, const QString& fileName)
+    : AudioDeviceIn(parent, QAudioDeviceInfo()),
+      m_fileName(fileName),
+      m_realTime(false),
+      m_thread(0)
+{
+    setDeviceName(QFileInfo(fileName).fileName());
+    setDefaultFormat();
+}
+
+AudioDeviceInFile::~AudioDeviceInFile()
+{
+    iClose();
+}
+
+const QString& AudioDeviceInFile::getFileName() const
+{
+    return m_fileName;
+}
+
+/**
+ * @brief If enabled, the file is played back at its sample rate instead of as fast as possible.
+ * Takes effect with the next start.
+ */
+void AudioDeviceInFile::setRealTime(bool realTime)
+{
+    m_realTime = realTime;
+}
+
+bool AudioDeviceInFile::isRealTime() const
+{
+    return m_realTime;
+}
+
+bool AudioDeviceInFile::iInit(const QAudioDeviceInfo& info)
+{
+    Q_UNUSED(info);
+
+    iClose();
+
+    // use the format of the file if it has a header
+    WavFile file(m_fileName);
+    if (!file.openRead(getFormat()))
+        return false;
+
+    setFormat(file.getFormat());
+    file.close();
+
+    // a file can always wait for the consumers
+    getConsumerList()->create(getFormat());
+    getConsumerList()->setBlocking(true);
+
+    return true;
+}
+
+bool AudioDeviceInFile::iClose()
+{
+    if (m_thread) {
+        delete m_thread;
+        m_thread = 0;
+    }
+
+    return true;
+}
+
+bool AudioDeviceInFile::start()
+{
+    if (!isReady() || isOpen())
+        return false;
+
+    iClose();
+
+    m_thread = new AudioDeviceInFileThread(m_fileName, getFormat(), getConsumerList(), m_realTime);
+    m_thread->start();
+
+    return true;
+}
+
+bool AudioDeviceInFile::stop()
+{
+    if (m_thread) {
+        m_thread->stopAudio();
+        m_thread->wait();
+        return true;
+    }
+
+    return false;
+}
+
+bool AudioDeviceInFile::isOpen() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+int AudioDeviceInFile::getBufferSize() const
+{
+    if (m_thread)
+        return m_thread->getPeriodSize();
+
+    return -1;
+}
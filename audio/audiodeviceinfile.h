@@ -0,0 +1,77 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef AUDIODEVICEINFILE_H
+#define AUDIODEVICEINFILE_H
+
+#include "audiodevicein.h"
+
+namespace Digital {
+namespace Internal {
+
+class AudioDeviceInFileThread;
+
+/**
+ * @brief The AudioDeviceInFile class is an input device that plays back a recording instead
+ * of capturing from a soundcard. WAV files use the format stored in the file, any other file
+ * is read as raw PCM data in the format that has been set on the device.
+ *
+ * The data is passed to the same consumers as for a soundcard. Unless real-time mode is
+ * enabled, the file is read as fast as the consumers process the data and no block is
+ * dropped.
+ */
+class AudioDeviceInFile
+        : public AudioDeviceIn
+{
+    Q_OBJECT
+
+public:
+    AudioDeviceInFile(QObject* parent, const QString& fileName);
+    ~AudioDeviceInFile();
+
+    const QString& getFileName() const;
+
+    void setRealTime(bool);
+    bool isRealTime() const;
+
+    bool start();
+    bool stop();
+    bool isOpen() const;
+    int getBufferSize() const;
+
+protected:
+    bool iInit(const QAudioDeviceInfo&);
+    bool iClose();
+
+private:
+    QString                     m_fileName;
+    bool                        m_realTime;
+    AudioDeviceInFileThread*    m_thread;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // AUDIODEVICEINFILE_H
@@ -0,0 +1,105 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "audiodeviceinfilethread.h"
+#include "wavfile.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+using namespace Digital::Internal;
+
+AudioDeviceInFileThread::AudioDeviceInFileThread(const QString& fileName, QAudioFormat format,
+                                                 QIODevice* ioDevice, bool realTime)
+    : m_fileName(fileName),
+      m_format(format),
+      m_ioDevice(ioDevice),
+      m_realTime(realTime),
+      m_terminate(0)
+{
+}
+
+AudioDeviceInFileThread::~AudioDeviceInFileThread()
+{
+    stopAudio();
+    wait();
+}
+
+void AudioDeviceInFileThread::stopAudio()
+{
+    m_terminate.store(1);
+}
+
+/**
+ * @brief Returns the number of bytes that are written at once, similar to the period size of
+ * a soundcard
+ */
+int AudioDeviceInFileThread::getPeriodSize() const
+{
+    return 1024 * (m_format.sampleSize() / 8) * m_format.channelCount();
+}
+
+void AudioDeviceInFileThread::run()
+{
+    WavFile file(m_fileName);
+    if (!file.openRead(m_format))
+        return;
+
+    if (!m_ioDevice->isOpen())
+        m_ioDevice->open(QIODevice::WriteOnly);
+
+    const int frameSize = (m_format.sampleSize() / 8) * m_format.channelCount();
+    const int periodSize = getPeriodSize();
+    QByteArray buffer(periodSize, 0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 bytesLeft = file.getDataLength() - file.getDataLength() % frameSize;
+    qint64 framesWritten = 0;
+    while (bytesLeft > 0 && !m_terminate.load()) {
+        qint64 len = file.read(buffer.data(), qMin<qint64>(periodSize, bytesLeft));
+        len -= len % frameSize;
+        if (len <= 0)
+            break;
+
+        m_ioDevice->write(buffer.constData(), len);
+        bytesLeft -= len;
+        framesWritten += len / frameSize;
+
+        // do not run ahead of the sample rate in real-time mode
+        if (m_realTime) {
+            qint64 due = framesWritten * 1000 / m_format.sampleRate();
+            qint64 elapsed = timer.elapsed();
+            if (due > elapsed)
+                msleep(due - elapsed);
+        }
+    }
+
+    if (m_ioDevice->isOpen())
+        m_ioDevice->close();
+
+    qDebug() << "finished reading" << m_fileName << "in" << timer.elapsed() << "ms";
+}
@@ -22,56 +22,48 @@
  *
  **********************************************************************/
 
-#ifndef CIRCULARBUFFER_H
-#define CIRCULARBUFFER_H
 
-#include <QIODevice>
+#ifndef AUDIODEVICEINFILETHREAD_H
+#define AUDIODEVICEINFILETHREAD_H
+
+#include <QThread>
 #include <QAudioFormat>
-#include <QMutex>
-#include <QVector>
-#include <QWaitCondition>
+#include <QIODevice>
+#include <QAtomicInt>
 
 namespace Digital {
 namespace Internal {
 
-// TODO: implement multiple channels
-class CircularBuffer
-        : public QIODevice
+/**
+ * @brief The AudioDeviceInFileThread class reads an audio file period by period and writes
+ * the data into the consumer list. Without throttling it runs as fast as the consumers
+ * accept the data, otherwise it sleeps to keep up with the sample rate of the file.
+ */
+class AudioDeviceInFileThread
+        : public QThread
 {
     Q_OBJECT
 
-public:
-    CircularBuffer(const QAudioFormat& format, qint64 samples, QObject*);
-    ~CircularBuffer();
-
-    void clear();
+    friend class AudioDeviceInFile;
 
-    qint64 readData(char*, qint64);
-    qint64 writeData(const char*, qint64);
-    qint64 writeData(const double& sample);
-
-    qint64 getBufferSize() const;
-    qint64 getBufferCapacity() const;
-    qint64 getFreeSpace() const;
+private:
+    AudioDeviceInFileThread(const QString& fileName, QAudioFormat format, QIODevice* ioDevice,
+                            bool realTime);
+    ~AudioDeviceInFileThread();
 
-    bool isEmpty() const;
-    bool isFull() const;
+    void stopAudio();
+    int getPeriodSize() const;
 
-signals:
-    void bytesRead(qint64);
-    void bytesWritten(qint64);
+    void run();
 
-private:
-    qint64 m_readPtr;
-    qint64 m_writePtr;
-    qint64 m_bufferSize;
-    qint64 m_bufferCapacity;
-    QVector<double> m_buffer;
-    const QAudioFormat m_format;
-    const int m_bytesPerSample;
+    QString             m_fileName;
+    QAudioFormat        m_format;
+    QIODevice*          m_ioDevice;
+    bool                m_realTime;
+    QAtomicInt          m_terminate;
 };
 
 } // namespace Internal
 } // namespace Digital
 
-#endif // CIRCULARBUFFER_H
+#endif // AUDIODEVICEINFILETHREAD_H
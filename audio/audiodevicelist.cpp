@@ -23,6 +23,8 @@
  **********************************************************************/
 
 #include "audiodevicelist.h"
+#include "audiodeviceinfile.h"
+#include "audiodeviceoutfile.h"
 
 using namespace Digital::Internal;
 
@@ -72,6 +74,27 @@ void AudioDeviceList::enumerate()
     }
 }
 
+/**
+ * @brief Adds an input device that reads from a recording instead of a soundcard
+ */
+AudioDeviceIn* AudioDeviceList::addInputFile(const QString& fileName, bool realTime)
+{
+    AudioDeviceInFile* inputDevice = new AudioDeviceInFile(this, fileName);
+    inputDevice->setRealTime(realTime);
+    m_inDevices.push_back(inputDevice);
+    return inputDevice;
+}
+
+/**
+ * @brief Adds an output device that renders into a WAV file instead of a soundcard
+ */
+AudioDeviceOut* AudioDeviceList::addOutputFile(const QString& fileName)
+{
+    AudioDeviceOutFile* outputDevice = new AudioDeviceOutFile(this, fileName);
+    m_outDevices.push_back(outputDevice);
+    return outputDevice;
+}
+
 const QList<AudioDeviceIn*>& AudioDeviceList::getInputDevices() const
 {
     return m_inDevices;
@@ -43,6 +43,8 @@ public:
     ~AudioDeviceList();
 
     void enumerate();
+    AudioDeviceIn* addInputFile(const QString& fileName, bool realTime);
+    AudioDeviceOut* addOutputFile(const QString& fileName);
 
     const QList<AudioDeviceIn*>& getInputDevices() const;
     const QList<AudioDeviceOut*>& getOutputDevices() const;
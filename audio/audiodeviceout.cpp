@@ -68,6 +68,11 @@ bool AudioDeviceOut::iClose()
     return true;
 }
 
+AudioProducerList* AudioDeviceOut::getProducerList() const
+{
+    return m_producerList;
+}
+
 bool AudioDeviceOut::start()
 {
     if (m_thread && m_thread->isStarted()) {
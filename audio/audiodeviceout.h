@@ -65,6 +65,8 @@ protected:
     bool iInit(const QAudioDeviceInfo&);
     bool iClose();
 
+    AudioProducerList* getProducerList() const;
+
 private:
     QMutex                  m_initMutex;
     QWaitCondition          m_initCond;
@@ -0,0 +1,124 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "audiodeviceoutfile.h"
+#include "audiodeviceoutfilethread.h"
+#include "audioproducerlist.h"
+#include "wavfile.h"
+#include <QFileInfo>
+#include <QDebug>
+
+using namespace Digital::Internal;
+
+AudioDeviceOutFile::AudioDeviceOutFile(QObject* parent, const QString& fileName)
+    : AudioDeviceOut(parent, QAudioDeviceInfo()),
+      m_fileName(fileName),
+      m_file(0),
+      m_thread(0)
+{
+    setDeviceName(fileName.isEmpty() ? QString("Null output") : QFileInfo(fileName).fileName());
+    setDefaultFormat();
+
+    // the file is written as fast as the producer delivers, without silence for underruns
+    getProducerList()->setRealTime(false);
+}
+
+AudioDeviceOutFile::~AudioDeviceOutFile()
+{
+    iClose();
+}
+
+const QString& AudioDeviceOutFile::getFileName() const
+{
+    return m_fileName;
+}
+
+bool AudioDeviceOutFile::iInit(const QAudioDeviceInfo& info)
+{
+    Q_UNUSED(info);
+
+    iClose();
+
+    if (!m_fileName.isEmpty()) {
+        m_file = new WavFile(m_fileName);
+        if (!m_file->openWrite(getFormat())) {
+            delete m_file;
+            m_file = 0;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AudioDeviceOutFile::iClose()
+{
+    if (m_thread) {
+        delete m_thread;
+        m_thread = 0;
+    }
+
+    if (m_file) {
+        delete m_file;
+        m_file = 0;
+    }
+
+    return true;
+}
+
+bool AudioDeviceOutFile::start()
+{
+    if (!isReady() || isOpen())
+        return false;
+
+    delete m_thread;
+    m_thread = new AudioDeviceOutFileThread(getFormat(), getProducerList(), m_file);
+    m_thread->start();
+
+    return true;
+}
+
+bool AudioDeviceOutFile::stop()
+{
+    if (m_thread) {
+        m_thread->stopAudio();
+        return true;
+    }
+
+    return false;
+}
+
+bool AudioDeviceOutFile::isOpen() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+int AudioDeviceOutFile::getBufferSize() const
+{
+    if (m_thread)
+        return m_thread->getPeriodSize();
+
+    return -1;
+}
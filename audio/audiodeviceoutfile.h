@@ -0,0 +1,72 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef AUDIODEVICEOUTFILE_H
+#define AUDIODEVICEOUTFILE_H
+
+#include "audiodeviceout.h"
+
+namespace Digital {
+namespace Internal {
+
+class AudioDeviceOutFileThread;
+class WavFile;
+
+/**
+ * @brief The AudioDeviceOutFile class is an output device that renders the transmitted audio
+ * into a WAV file instead of playing it on a soundcard. Samples are pulled as fast as the
+ * producer generates them. All transmissions until the device is closed are appended to the
+ * same file. Without a file name the audio is discarded, which is useful for benchmarks.
+ */
+class AudioDeviceOutFile
+        : public AudioDeviceOut
+{
+    Q_OBJECT
+
+public:
+    AudioDeviceOutFile(QObject* parent, const QString& fileName);
+    ~AudioDeviceOutFile();
+
+    const QString& getFileName() const;
+
+    bool start();
+    bool stop();
+    bool isOpen() const;
+    int getBufferSize() const;
+
+protected:
+    bool iInit(const QAudioDeviceInfo&);
+    bool iClose();
+
+private:
+    QString                     m_fileName;
+    WavFile*                    m_file;
+    AudioDeviceOutFileThread*   m_thread;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // AUDIODEVICEOUTFILE_H
@@ -0,0 +1,105 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "audiodeviceoutfilethread.h"
+#include "audioproducerlist.h"
+#include "wavfile.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+using namespace Digital::Internal;
+
+AudioDeviceOutFileThread::AudioDeviceOutFileThread(QAudioFormat format,
+                                                   AudioProducerList* producerList, WavFile* file)
+    : m_format(format),
+      m_producerList(producerList),
+      m_file(file),
+      m_terminate(0),
+      m_bytesWritten(0)
+{
+}
+
+AudioDeviceOutFileThread::~AudioDeviceOutFileThread()
+{
+    stopAudio();
+    wait();
+}
+
+/**
+ * @brief Stops pulling data after the current period, a wait for the samples of the producer
+ * is cancelled
+ */
+void AudioDeviceOutFileThread::stopAudio()
+{
+    m_terminate.store(1);
+    m_producerList->cancelWaitForReadyRead();
+}
+
+int AudioDeviceOutFileThread::getPeriodSize() const
+{
+    return 1024 * (m_format.sampleSize() / 8) * m_format.channelCount();
+}
+
+qint64 AudioDeviceOutFileThread::getBytesWritten() const
+{
+    return m_bytesWritten;
+}
+
+void AudioDeviceOutFileThread::run()
+{
+    if (!m_producerList->isOpen())
+        m_producerList->open(QIODevice::ReadOnly);
+
+    QByteArray buffer(getPeriodSize(), 0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // the file is rendered as fast as the producer delivers, so this thread waits for it when
+    // the buffer runs empty, until it has been stopped
+    while (!m_terminate.load()) {
+        qint64 len = m_producerList->read(buffer.data(), buffer.size());
+        if (len < 0)
+            break;
+        if (len == 0) {
+            if (!m_producerList->waitForReadyRead(-1))
+                break;
+            continue;
+        }
+
+        if (m_file)
+            m_file->write(buffer.constData(), len);
+        m_bytesWritten += len;
+    }
+
+    if (m_file)
+        m_file->updateHeader();
+
+    if (m_producerList->isOpen())
+        m_producerList->close();
+
+    qDebug() << "rendered" << m_bytesWritten << "bytes in" << timer.elapsed() << "ms";
+}
@@ -22,59 +22,50 @@
  *
  **********************************************************************/
 
-#ifndef AUDIORINGBUFFER_H
-#define AUDIORINGBUFFER_H
 
-#include <QIODevice>
+#ifndef AUDIODEVICEOUTFILETHREAD_H
+#define AUDIODEVICEOUTFILETHREAD_H
+
+#include <QThread>
 #include <QAudioFormat>
-#include <QMutex>
-#include <QVector>
-#include <QWaitCondition>
+#include <QAtomicInt>
 
 namespace Digital {
 namespace Internal {
 
-// TODO: implement multiple channels
-class AudioRingBuffer
-        : public QIODevice
+class WavFile;
+class AudioProducerList;
+
+/**
+ * @brief The AudioDeviceOutFileThread class pulls samples from the producer list period by
+ * period, as a soundcard would, but without waiting for the hardware. The data is written to
+ * a file or discarded if there is no file.
+ */
+class AudioDeviceOutFileThread
+        : public QThread
 {
     Q_OBJECT
 
-public:
-    AudioRingBuffer(const QAudioFormat& format, qint64 samples, QObject*);
-    AudioRingBuffer(const QAudioFormat& format, double sec, QObject*);
-    ~AudioRingBuffer();
-
-    qint64 writeData(const char*, qint64);
-    qint64 readData(char*, qint64);
-
-    bool isEmpty() const;
+    friend class AudioDeviceOutFile;
 
-    // TODO: write samples
-    qint64 writeData(const double& sample);
-    qint64 writeData(const QVector<double>&);
-
-    qint64 getBuffer(QVector<double>&) const;
-    qint64 getBuffer(QVector<double>&, qint64) const;
-    qint64 getBufferLength() const;
-    qint64 getBufferSize() const;
+private:
+    AudioDeviceOutFileThread(QAudioFormat format, AudioProducerList* producerList, WavFile* file);
+    ~AudioDeviceOutFileThread();
 
-signals:
-    void bytesRead(qint64);
-    void bytesWritten(qint64);
+    void stopAudio();
+    int getPeriodSize() const;
+    qint64 getBytesWritten() const;
 
-private:
-    const QAudioFormat m_format;
-    QVector<double> m_buffer;
-    qint64 m_bufferSize;
-    qint64 m_bufferLength;
-    qint64 m_position;
+    void run();
 
-    mutable QMutex m_lock;
-    QWaitCondition m_canWrite;
+    QAudioFormat        m_format;
+    AudioProducerList*  m_producerList;
+    WavFile*            m_file;
+    QAtomicInt          m_terminate;
+    qint64              m_bytesWritten;
 };
 
 } // namespace Internal
 } // namespace Digital
 
-#endif // AUDIORINGBUFFER_H
+#endif // AUDIODEVICEOUTFILETHREAD_H
@@ -0,0 +1,256 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "audiopcmconverter.h"
+
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIOPCMCONVERTER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Digital::Internal;
+
+namespace {
+
+// linear mapping of the integer range of each sample type to [-1, 1]
+template <typename T>
+struct PcmScale;
+
+template <> struct PcmScale<quint8>
+{
+    static double scale() { return 2.0 / 255.0; }
+    static double offset() { return -1.0; }
+};
+
+template <> struct PcmScale<qint8>
+{
+    static double scale() { return 1.0 / 127.0; }
+    static double offset() { return 0.0; }
+};
+
+template <> struct PcmScale<quint16>
+{
+    static double scale() { return 2.0 / 65535.0; }
+    static double offset() { return -1.0; }
+};
+
+template <> struct PcmScale<qint16>
+{
+    static double scale() { return 1.0 / 32767.0; }
+    static double offset() { return 0.0; }
+};
+
+template <> struct PcmScale<quint32>
+{
+    static double scale() { return 2.0 / 4294967295.0; }
+    static double offset() { return -1.0; }
+};
+
+template <> struct PcmScale<qint32>
+{
+    static double scale() { return 1.0 / 2147483647.0; }
+    static double offset() { return 0.0; }
+};
+
+template <> struct PcmScale<float>
+{
+    static double scale() { return 1.0; }
+    static double offset() { return 0.0; }
+};
+
+template <typename T, QAudioFormat::Endian E>
+struct PcmReader
+{
+    static double read(const unsigned char* ptr)
+    {
+        if (E == QAudioFormat::BigEndian)
+            return qFromBigEndian<T>(ptr);
+        else
+            return qFromLittleEndian<T>(ptr);
+    }
+};
+
+template <QAudioFormat::Endian E>
+struct PcmReader<float, E>
+{
+    static double read(const unsigned char* ptr)
+    {
+        quint32 bits = PcmReader<quint32, E>::read(ptr);
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        return value;
+    }
+};
+
+template <typename T, QAudioFormat::Endian E>
+void pcmToRealKernel(const unsigned char* ptr, double* out, qint64 frames, int stride)
+{
+    const double scale = PcmScale<T>::scale();
+    const double offset = PcmScale<T>::offset();
+
+    for (qint64 i = 0; i < frames; i++, ptr += stride)
+        out[i] = PcmReader<T, E>::read(ptr) * scale + offset;
+}
+
+#ifdef AUDIOPCMCONVERTER_SSE2
+// 16 bit signed mono is the format that is used by default, convert it 8 samples at a time
+template <>
+void pcmToRealKernel<qint16, QAudioFormat::LittleEndian>(const unsigned char* ptr, double* out,
+                                                         qint64 frames, int stride)
+{
+    if (stride != sizeof(qint16)) {
+        const double scale = PcmScale<qint16>::scale();
+        for (qint64 i = 0; i < frames; i++, ptr += stride)
+            out[i] = qFromLittleEndian<qint16>(ptr) * scale;
+        return;
+    }
+
+    const __m128d scale = _mm_set1_pd(PcmScale<qint16>::scale());
+    qint64 i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i * sizeof(qint16)));
+
+        // sign extend to 32 bit integers
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+
+        _mm_storeu_pd(out + i,     _mm_mul_pd(_mm_cvtepi32_pd(lo), scale));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(lo, 0x4e)), scale));
+        _mm_storeu_pd(out + i + 4, _mm_mul_pd(_mm_cvtepi32_pd(hi), scale));
+        _mm_storeu_pd(out + i + 6, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(hi, 0x4e)), scale));
+    }
+
+    for (; i < frames; i++)
+        out[i] = qFromLittleEndian<qint16>(ptr + i * sizeof(qint16)) * PcmScale<qint16>::scale();
+}
+#endif
+
+template <typename T>
+void (*selectByteOrder(QAudioFormat::Endian endian))(const unsigned char*, double*, qint64, int)
+{
+    if (endian == QAudioFormat::BigEndian)
+        return &pcmToRealKernel<T, QAudioFormat::BigEndian>;
+    else
+        return &pcmToRealKernel<T, QAudioFormat::LittleEndian>;
+}
+
+} // namespace
+
+AudioPcmConverter::AudioPcmConverter()
+    : m_kernel(0),
+      m_bytesPerFrame(0)
+{
+}
+
+AudioPcmConverter::AudioPcmConverter(const QAudioFormat& format)
+    : m_kernel(0),
+      m_bytesPerFrame(0)
+{
+    setFormat(format);
+}
+
+void AudioPcmConverter::setFormat(const QAudioFormat& format)
+{
+    m_format = format;
+    m_kernel = selectKernel(format);
+    m_bytesPerFrame = (format.sampleSize() / 8) * format.channelCount();
+}
+
+const QAudioFormat& AudioPcmConverter::getFormat() const
+{
+    return m_format;
+}
+
+bool AudioPcmConverter::isValid() const
+{
+    return m_kernel != 0 && m_bytesPerFrame > 0;
+}
+
+int AudioPcmConverter::getBytesPerFrame() const
+{
+    return m_bytesPerFrame;
+}
+
+/**
+ * @brief Converts a block of frames into real samples
+ * @param data the PCM data, at least frames * getBytesPerFrame() bytes
+ * @param frames the number of frames to convert
+ * @param out receives one real sample per frame
+ * @return the number of converted frames
+ */
+qint64 AudioPcmConverter::convert(const char* data, qint64 frames, double* out) const
+{
+    if (!isValid() || !data || frames <= 0)
+        return 0;
+
+    m_kernel(reinterpret_cast<const unsigned char*>(data), out, frames, m_bytesPerFrame);
+    return frames;
+}
+
+AudioPcmConverter::Kernel AudioPcmConverter::selectKernel(const QAudioFormat& format)
+{
+    if (!format.isValid())
+        return 0;
+
+    if (format.codec() != QString::fromLatin1("audio/pcm")) {
+        qCritical() << "format is not pcm";
+        return 0;
+    }
+
+    const QAudioFormat::Endian endian = format.byteOrder();
+
+    switch (format.sampleSize()) {
+    case 8:
+        if (format.sampleType() == QAudioFormat::UnSignedInt)
+            return selectByteOrder<quint8>(endian);
+        else if (format.sampleType() == QAudioFormat::SignedInt)
+            return selectByteOrder<qint8>(endian);
+        break;
+    case 16:
+        if (format.sampleType() == QAudioFormat::UnSignedInt)
+            return selectByteOrder<quint16>(endian);
+        else if (format.sampleType() == QAudioFormat::SignedInt)
+            return selectByteOrder<qint16>(endian);
+        break;
+    case 32:
+        if (format.sampleType() == QAudioFormat::UnSignedInt)
+            return selectByteOrder<quint32>(endian);
+        else if (format.sampleType() == QAudioFormat::SignedInt)
+            return selectByteOrder<qint32>(endian);
+        else if (format.sampleType() == QAudioFormat::Float)
+            return selectByteOrder<float>(endian);
+        break;
+    default:
+        qCritical() << "unknown sample size: " << format.sampleSize();
+        return 0;
+    }
+
+    qCritical() << "unsupported sample type";
+    return 0;
+}
@@ -0,0 +1,67 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef AUDIOPCMCONVERTER_H
+#define AUDIOPCMCONVERTER_H
+
+#include <QAudioFormat>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The AudioPcmConverter class converts blocks of PCM frames into real samples in the
+ * range [-1, 1]. The audio format is resolved once in setFormat() into a conversion kernel
+ * that is specialized at compile time for the sample type and byte order, so converting a
+ * period does not need to inspect the format for every sample. Only the first channel of
+ * each frame is converted.
+ */
+class AudioPcmConverter
+{
+public:
+    AudioPcmConverter();
+    explicit AudioPcmConverter(const QAudioFormat&);
+
+    void setFormat(const QAudioFormat&);
+    const QAudioFormat& getFormat() const;
+    bool isValid() const;
+    int getBytesPerFrame() const;
+
+    qint64 convert(const char* data, qint64 frames, double* out) const;
+
+private:
+    typedef void (*Kernel)(const unsigned char*, double*, qint64, int);
+
+    static Kernel selectKernel(const QAudioFormat&);
+
+    QAudioFormat    m_format;
+    Kernel          m_kernel;
+    int             m_bytesPerFrame;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // AUDIOPCMCONVERTER_H
@@ -24,101 +24,204 @@
 
 #include "audioproducer.h"
 #include "audioproducerlist.h"
+#include "audiodevice.h"
+#include <QElapsedTimer>
 #include <QDebug>
 
 using namespace Digital::Internal;
 
+const unsigned long AudioProducer::MAX_POLL_INTERVAL = 8;
+
 AudioProducer::AudioProducer(QObject* parent, qint32 bufferSize)
     : QObject(parent),
+      m_bytesPerSample(0),
       m_bufferSize(bufferSize),
-      m_buffer(0),
-      m_terminate(false),
-      m_dataRequested(0),
-      m_dataGenerated(0),
-      m_bytesPerSample(0)
+      m_terminate(0),
+      m_readerWaiting(0),
+      m_cancelWait(false)
 {
 }
 
 AudioProducer::~AudioProducer()
 {
-    delete m_buffer;
 }
 
 void AudioProducer::create(QAudioFormat format)
 {
-    if (m_buffer)
+    if (m_buffer.getCapacity() > 0)
         return;
 
     m_format = format;
     m_bytesPerSample = (m_format.sampleSize() / 8) * m_format.channelCount();
-    m_buffer = new CircularBuffer(m_format, m_bufferSize, this);
+    m_buffer.resize(m_bufferSize);
 }
 
+/**
+ * @brief Called by the soundcard to fetch samples. Only the ring buffer indices are touched
+ * here, the call never waits or locks. Until the producer has been stopped, missing samples
+ * are filled with silence, as a short read makes the soundcard idle, which stops it. Once
+ * stopped, the remaining samples are returned and then no more.
+ */
 qint64 AudioProducer::read(char* data, qint64 maxlen)
 {
-    if (m_terminate)
+    if (m_bytesPerSample == 0)
+        return 0;
+
+    const qint64 samples = readAvailable(data, maxlen) / m_bytesPerSample;
+    if (m_terminate.load())
+        return samples * m_bytesPerSample;
+
+    const qint64 frames = maxlen / m_bytesPerSample;
+    for (qint64 i = samples; i < frames; i++)
+        AudioDevice::realToPcm(m_format, 0, data + i * m_bytesPerSample);
+
+    return frames * m_bytesPerSample;
+}
+
+/**
+ * @brief Fetches the samples that are available without waiting, possibly none, for outputs
+ * that are not driven by a clock
+ */
+qint64 AudioProducer::readAvailable(char* data, qint64 maxlen)
+{
+    if (m_bytesPerSample == 0)
         return 0;
 
-    // request samples and wait until the buffer is sufficiently filled
-    QMutexLocker lock(&m_bufferMutex);
+    const double* first;
+    const double* second;
+    qint64 firstSize, secondSize;
+    qint64 samples = qMin(m_buffer.getReadSpans(first, firstSize, second, secondSize),
+                          maxlen / m_bytesPerSample);
+
+    // convert in place and release the samples afterwards
+    qint64 firstCount = qMin(samples, firstSize);
+    for (qint64 i = 0; i < firstCount; i++)
+        AudioDevice::realToPcm(m_format, first[i], data + i * m_bytesPerSample);
+    for (qint64 i = firstCount; i < samples; i++)
+        AudioDevice::realToPcm(m_format, second[i - firstCount], data + i * m_bytesPerSample);
+
+    m_buffer.commitRead(samples);
+
+    return samples * m_bytesPerSample;
+}
+
+/**
+ * @brief Blocks until samples are available, the producer has been stopped, cancelWait() has
+ * been called or msecs have passed, for outputs that are not driven by a clock. A negative
+ * timeout waits without limit. Returns true if samples are available.
+ */
+bool AudioProducer::waitForData(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker lock(&m_waitMutex);
+    m_readerWaiting.fetchAndStoreOrdered(1);
+    while (m_buffer.isEmpty() && !m_terminate.load() && !m_cancelWait) {
+        if (msecs < 0) {
+            m_dataAvailable.wait(&m_waitMutex);
+            continue;
+        }
+
+        const qint64 remaining = msecs - timer.elapsed();
+        if (remaining <= 0)
+            break;
+        m_dataAvailable.wait(&m_waitMutex, (unsigned long)remaining);
+    }
+    m_readerWaiting.fetchAndStoreOrdered(0);
+    m_cancelWait = false;
+
+    return !m_buffer.isEmpty();
+}
 
-    // the number of samples that are requested (maxlen is in bytes while m_buffer->getBufferCapacity() is in # samples)
-    m_dataRequested = qMin(maxlen / m_bytesPerSample, m_buffer->getBufferCapacity());
+/**
+ * @brief Makes the current or the next waitForData() return, e.g. when the output is closed
+ * while the producer is still running
+ */
+void AudioProducer::cancelWait()
+{
+    QMutexLocker lock(&m_waitMutex);
+    m_cancelWait = true;
+    m_dataAvailable.wakeAll();
+}
 
-    // wait until data is available in the buffer
-    m_dataWaitCond.wakeAll();
-    while (m_dataGenerated == 0 && !m_terminate)
-        m_waitCond.wait(&m_bufferMutex);
+/**
+ * @brief Wakes a reader that waits for data. The flag is set with the mutex held before the
+ * reader checks the buffer, and both sides access it with full barriers after changing the
+ * buffer. So either the reader sees the change, or this side sees the flag and wakes it under
+ * the mutex, which the reader only releases by waiting.
+ */
+void AudioProducer::wakeReader()
+{
+    if (m_readerWaiting.fetchAndAddOrdered(0)) {
+        QMutexLocker lock(&m_waitMutex);
+        m_dataAvailable.wakeAll();
+    }
+}
 
-    // read data from the buffer
-    qint64 dataRead = 0;
-    if (m_dataGenerated > 0)
-        dataRead = m_buffer->read(data, m_dataGenerated * m_bytesPerSample);
-    m_dataGenerated = 0;
-    m_stopCond.wakeAll();
-    return dataRead;
+/**
+ * @brief Sleeps while the reader makes room in the buffer. The reader runs in the audio
+ * callback and never signals, so the buffer is polled, first often and then every
+ * MAX_POLL_INTERVAL ms.
+ */
+void AudioProducer::waitForSpace(bool untilEmpty)
+{
+    unsigned long interval = 1;
+    while (untilEmpty ? !m_buffer.isEmpty() : m_buffer.isFull()) {
+        QThread::msleep(interval);
+        interval = qMin(2 * interval, MAX_POLL_INTERVAL);
+    }
 }
 
 void AudioProducer::write(const double& sample)
 {
-    // wait until a number of samples has been requested
-    QMutexLocker lock(&m_bufferMutex);
-    while (m_dataRequested == 0)
-        m_dataWaitCond.wait(&m_bufferMutex);
+    write(&sample, 1);
+}
 
-    if (sample < -1 || sample > 1)
-        qWarning() << "samples are out of range";
+/**
+ * @brief Writes a block of samples. The block is copied into the buffer in as few pieces as
+ * possible, the call only synchronizes with the audio device when the buffer is full.
+ */
+void AudioProducer::write(const double* samples, qint64 count)
+{
+    for (qint64 i = 0; i < count; i++) {
+        if (samples[i] < -1 || samples[i] > 1) {
+            qWarning() << "samples are out of range";
+            break;
+        }
+    }
 
-    // if there is enough space in the buffer, write the sample to the buffer
-    m_buffer->writeData(sample);
+    while (count > 0) {
+        waitForSpace(false);
 
-    // if the buffer is filled sufficiently, signal that data can be read
-    if (m_buffer->getBufferSize() >= m_dataRequested) {
-        m_dataGenerated = m_buffer->getBufferSize();
-        m_waitCond.wakeAll();
-        m_dataRequested = 0;
+        qint64 written = m_buffer.write(samples, count);
+        samples += written;
+        count -= written;
+
+        wakeReader();
     }
 }
 
 void AudioProducer::start()
 {
-    m_dataRequested = 0;
-    m_terminate = false;
+    m_waitMutex.lock();
+    m_cancelWait = false;
+    m_waitMutex.unlock();
+
+    m_terminate.store(0);
     emit newDataAvailable();
 }
 
 void AudioProducer::stop()
 {
-    QMutexLocker lock(&m_bufferMutex);
-
-    // request to read all remaining data in the buffer
-    m_terminate = true;
-    m_dataGenerated = m_buffer->getBufferSize();
-    m_waitCond.wakeAll();
+    // let the audio device read all remaining data in the buffer
+    m_waitMutex.lock();
+    m_terminate.store(1);
+    m_dataAvailable.wakeAll();
+    m_waitMutex.unlock();
 
     // wait until the buffer is empty, then stop the audio
-    while (m_buffer->getBufferSize() > 0)
-        m_stopCond.wait(&m_bufferMutex);
+    waitForSpace(true);
 
     emit stopAudio();
 }
@@ -27,7 +27,10 @@
 
 #include <QObject>
 #include <QThread>
-#include "circularbuffer.h"
+#include <QAudioFormat>
+#include <QMutex>
+#include <QWaitCondition>
+#include "lockfreeringbuffer.h"
 
 namespace Digital {
 namespace Internal {
@@ -48,6 +51,9 @@ public:
     virtual void create(QAudioFormat);
 
     qint64 read(char* data, qint64 maxlen);
+    qint64 readAvailable(char* data, qint64 maxlen);
+    bool waitForData(int msecs);
+    void cancelWait();
 
     virtual void start();
     virtual void stop();
@@ -58,6 +64,7 @@ signals:
 
 protected:
     void write(const double& sample);
+    void write(const double* samples, qint64 count);
 
     const QAudioFormat& getFormat() const;
 
@@ -65,19 +72,20 @@ protected:
     virtual void unregistered();
 
 private:
-    qint64 m_dataRequested;
-    qint64 m_dataGenerated;
-    QWaitCondition m_dataWaitCond;
-    QMutex m_dataMutex;
-    QWaitCondition m_stopCond;
+    void wakeReader();
+    void waitForSpace(bool untilEmpty);
+
+    static const unsigned long MAX_POLL_INTERVAL;   // in ms
 
     int m_bytesPerSample;
     QAudioFormat m_format;
     qint32 m_bufferSize;
-    QMutex m_bufferMutex;
-    QWaitCondition m_waitCond;
-    CircularBuffer* m_buffer;
-    bool m_terminate;
+    LockFreeRingBuffer<double> m_buffer;
+    QMutex m_waitMutex;
+    QWaitCondition m_dataAvailable;
+    QAtomicInt m_terminate;
+    QAtomicInt m_readerWaiting;     // set with m_waitMutex held before waiting for data
+    bool m_cancelWait;              // guarded by m_waitMutex
 };
 
 } // namespace Internal
@@ -32,7 +32,8 @@ using namespace Digital::Internal;
 
 AudioProducerList::AudioProducerList(AudioDeviceOut* device)
     : QIODevice(device),
-      m_device(device)
+      m_device(device),
+      m_realTime(true)
 {
 }
 
@@ -81,6 +82,15 @@ bool AudioProducerList::remove(AudioProducer* producer)
     return false;
 }
 
+/**
+ * @brief Selects how underruns are read. A real-time output gets silence while the producer is
+ * running, others only get the available samples and wait with waitForReadyRead().
+ */
+void AudioProducerList::setRealTime(bool realTime)
+{
+    m_realTime = realTime;
+}
+
 void AudioProducerList::requestSoundcard()
 {
     if (m_device && !m_device->isOpen()) {
@@ -95,6 +105,29 @@ void AudioProducerList::stopSoundcard()
     }
 }
 
+/**
+ * @brief Blocks until the producer has samples, for outputs that are not driven by a clock.
+ * Returns false after msecs, or without limit for -1, once the producer has been stopped and
+ * all of its samples have been read, or when cancelWaitForReadyRead() has been called.
+ */
+bool AudioProducerList::waitForReadyRead(int msecs)
+{
+    if (m_producerList.size() == 0)
+        return false;
+
+    return m_producerList[0]->waitForData(msecs);
+}
+
+/**
+ * @brief Makes a waitForReadyRead() in another thread return false, the next one if there is
+ * none at the moment
+ */
+void AudioProducerList::cancelWaitForReadyRead()
+{
+    if (m_producerList.size() > 0)
+        m_producerList[0]->cancelWait();
+}
+
 qint64 AudioProducerList::writeData(const char* data, qint64 len)
 {
     Q_UNUSED(data);
@@ -110,6 +143,8 @@ qint64 AudioProducerList::readData(char* data, qint64 maxlen)
 
     // read samples from the first producer
     AudioProducer* firstProducer = m_producerList[0];
-    int bytesRead = firstProducer->read(data, maxlen);
-    return bytesRead;
+    if (!m_realTime)
+        return firstProducer->readAvailable(data, maxlen);
+
+    return firstProducer->read(data, maxlen);
 }
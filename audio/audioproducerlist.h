@@ -44,6 +44,10 @@ public:
 
     bool add(AudioProducer*);
     bool remove(AudioProducer*);
+    void setRealTime(bool);
+
+    bool waitForReadyRead(int msecs);
+    void cancelWaitForReadyRead();
 
 public slots:
     void requestSoundcard();
@@ -56,6 +60,7 @@ protected:
 private:
     AudioDeviceOut* m_device;
     QList<AudioProducer*> m_producerList;
+    bool m_realTime;
 };
 
 } // namespace Internal
@@ -0,0 +1,257 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef LOCKFREERINGBUFFER_H
+#define LOCKFREERINGBUFFER_H
+
+#include <QAtomicInteger>
+#include <QVector>
+#include <string.h>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The LockFreeRingBuffer class is a single-producer/single-consumer ring buffer that
+ * does not use any locks. Exactly one thread may write to the buffer and exactly one thread
+ * may read from it at the same time.
+ *
+ * The capacity is rounded up to a power of two so that positions wrap with a mask. Both
+ * indices run freely and are only masked on access, the number of stored elements is their
+ * difference. The indices are placed on separate cache lines so that the reader and the
+ * writer do not invalidate each other's cache line on every access.
+ *
+ * Besides copying reads and writes, the buffer exposes its free and filled regions as at
+ * most two contiguous spans, so data can be produced or consumed in place.
+ */
+template <typename T>
+class LockFreeRingBuffer
+{
+public:
+    explicit LockFreeRingBuffer(qint64 capacity = 0);
+
+    void resize(qint64 capacity);
+    void clear();
+
+    qint64 getCapacity() const;
+    qint64 getReadAvailable() const;
+    qint64 getWriteAvailable() const;
+    bool isEmpty() const;
+    bool isFull() const;
+
+    // producer
+    qint64 write(const T* data, qint64 count);
+    qint64 write(const T& value);
+    qint64 getWriteSpans(T*& first, qint64& firstSize, T*& second, qint64& secondSize);
+    void commitWrite(qint64 count);
+
+    // consumer
+    qint64 read(T* data, qint64 count);
+    qint64 getReadSpans(const T*& first, qint64& firstSize, const T*& second, qint64& secondSize) const;
+    void commitRead(qint64 count);
+
+private:
+    enum { CacheLineSize = 64 };
+
+    LockFreeRingBuffer(const LockFreeRingBuffer&);
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer&);
+
+    char                    m_padding0[CacheLineSize];
+    QAtomicInteger<quint32> m_writeIndex;   // only modified by the producer
+    char                    m_padding1[CacheLineSize - sizeof(QAtomicInteger<quint32>)];
+    QAtomicInteger<quint32> m_readIndex;    // only modified by the consumer
+    char                    m_padding2[CacheLineSize - sizeof(QAtomicInteger<quint32>)];
+    quint32                 m_mask;
+    QVector<T>              m_buffer;
+};
+
+template <typename T>
+LockFreeRingBuffer<T>::LockFreeRingBuffer(qint64 capacity)
+    : m_writeIndex(0),
+      m_readIndex(0),
+      m_mask(0)
+{
+    resize(capacity);
+}
+
+/**
+ * @brief Sets the capacity to the next power of two and clears the buffer. This must not be
+ * called while any thread is reading or writing.
+ */
+template <typename T>
+void LockFreeRingBuffer<T>::resize(qint64 capacity)
+{
+    quint32 size = 1;
+    while (size < capacity && size < 0x80000000u)
+        size <<= 1;
+
+    m_buffer.resize(capacity > 0 ? size : 0);
+    m_mask = capacity > 0 ? size - 1 : 0;
+    clear();
+}
+
+/**
+ * @brief Discards all elements. This must not be called while any thread is reading or writing.
+ */
+template <typename T>
+void LockFreeRingBuffer<T>::clear()
+{
+    m_writeIndex.storeRelease(0);
+    m_readIndex.storeRelease(0);
+}
+
+template <typename T>
+qint64 LockFreeRingBuffer<T>::getCapacity() const
+{
+    return m_buffer.size();
+}
+
+template <typename T>
+qint64 LockFreeRingBuffer<T>::getReadAvailable() const
+{
+    return quint32(m_writeIndex.loadAcquire() - m_readIndex.loadAcquire());
+}
+
+template <typename T>
+qint64 LockFreeRingBuffer<T>::getWriteAvailable() const
+{
+    return m_buffer.size() - getReadAvailable();
+}
+
+template <typename T>
+bool LockFreeRingBuffer<T>::isEmpty() const
+{
+    return getReadAvailable() == 0;
+}
+
+template <typename T>
+bool LockFreeRingBuffer<T>::isFull() const
+{
+    return getWriteAvailable() == 0;
+}
+
+/**
+ * @brief Copies up to count elements into the buffer
+ * @return the number of elements that have been written
+ */
+template <typename T>
+qint64 LockFreeRingBuffer<T>::write(const T* data, qint64 count)
+{
+    T* first;
+    T* second;
+    qint64 firstSize, secondSize;
+    qint64 size = qMin(getWriteSpans(first, firstSize, second, secondSize), count);
+
+    qint64 firstCount = qMin(size, firstSize);
+    memcpy(first, data, firstCount * sizeof(T));
+    memcpy(second, data + firstCount, (size - firstCount) * sizeof(T));
+
+    commitWrite(size);
+    return size;
+}
+
+template <typename T>
+qint64 LockFreeRingBuffer<T>::write(const T& value)
+{
+    return write(&value, 1);
+}
+
+/**
+ * @brief Returns the free space as two contiguous spans. Write into the spans and publish the
+ * new elements with commitWrite().
+ * @return the total size of both spans
+ */
+template <typename T>
+qint64 LockFreeRingBuffer<T>::getWriteSpans(T*& first, qint64& firstSize, T*& second, qint64& secondSize)
+{
+    const quint32 writeIndex = m_writeIndex.load();
+    const quint32 free = m_buffer.size() - quint32(writeIndex - m_readIndex.loadAcquire());
+    const quint32 position = writeIndex & m_mask;
+
+    T* data = m_buffer.data();
+    first = data + position;
+    firstSize = qMin(free, quint32(m_buffer.size()) - position);
+    second = data;
+    secondSize = free - firstSize;
+    return free;
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::commitWrite(qint64 count)
+{
+    m_writeIndex.storeRelease(m_writeIndex.load() + quint32(count));
+}
+
+/**
+ * @brief Copies up to count elements out of the buffer
+ * @return the number of elements that have been read
+ */
+template <typename T>
+qint64 LockFreeRingBuffer<T>::read(T* data, qint64 count)
+{
+    const T* first;
+    const T* second;
+    qint64 firstSize, secondSize;
+    qint64 size = qMin(getReadSpans(first, firstSize, second, secondSize), count);
+
+    qint64 firstCount = qMin(size, firstSize);
+    memcpy(data, first, firstCount * sizeof(T));
+    memcpy(data + firstCount, second, (size - firstCount) * sizeof(T));
+
+    commitRead(size);
+    return size;
+}
+
+/**
+ * @brief Returns the stored elements as two contiguous spans, oldest first, without removing
+ * them. Release the elements with commitRead().
+ * @return the total size of both spans
+ */
+template <typename T>
+qint64 LockFreeRingBuffer<T>::getReadSpans(const T*& first, qint64& firstSize,
+                                           const T*& second, qint64& secondSize) const
+{
+    const quint32 readIndex = m_readIndex.load();
+    const quint32 available = quint32(m_writeIndex.loadAcquire() - readIndex);
+    const quint32 position = readIndex & m_mask;
+
+    const T* data = m_buffer.constData();
+    first = data + position;
+    firstSize = qMin(available, quint32(m_buffer.size()) - position);
+    second = data;
+    secondSize = available - firstSize;
+    return available;
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::commitRead(qint64 count)
+{
+    m_readIndex.storeRelease(m_readIndex.load() + quint32(count));
+}
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // LOCKFREERINGBUFFER_H
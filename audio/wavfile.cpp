@@ -0,0 +1,243 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "wavfile.h"
+#include <QtEndian>
+#include <QDebug>
+
+using namespace Digital::Internal;
+
+namespace {
+const quint16 WaveFormatPcm = 0x0001;
+const quint16 WaveFormatFloat = 0x0003;
+const quint16 WaveFormatExtensible = 0xfffe;
+}
+
+WavFile::WavFile(const QString& fileName, QObject* parent)
+    : QFile(fileName, parent),
+      m_dataLength(0),
+      m_raw(false),
+      m_writing(false)
+{
+}
+
+WavFile::~WavFile()
+{
+    close();
+}
+
+/**
+ * @brief Opens the file for reading and parses the header
+ * @param rawFormat the format that is assumed if the file has no RIFF header
+ * @return true if the file contains audio data in a supported format
+ */
+bool WavFile::openRead(const QAudioFormat& rawFormat)
+{
+    if (!open(QIODevice::ReadOnly)) {
+        qWarning() << "could not open" << fileName();
+        return false;
+    }
+
+    char magic[4];
+    if (peek(magic, 4) == 4 && memcmp(magic, "RIFF", 4) == 0) {
+        m_raw = false;
+        if (!readHeader()) {
+            qWarning() << "unsupported wave file" << fileName();
+            close();
+            return false;
+        }
+    }
+    else {
+        if (!rawFormat.isValid()) {
+            qWarning() << "no format given for raw file" << fileName();
+            close();
+            return false;
+        }
+
+        m_raw = true;
+        m_format = rawFormat;
+        m_dataLength = size();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Creates the file and writes a header for the given format. The sizes in the header
+ * are filled in by updateHeader() and close().
+ */
+bool WavFile::openWrite(const QAudioFormat& format)
+{
+    if (!format.isValid() || format.byteOrder() != QAudioFormat::LittleEndian) {
+        qWarning() << "unsupported format for wave file" << fileName();
+        return false;
+    }
+
+    if (!open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "could not create" << fileName();
+        return false;
+    }
+
+    m_format = format;
+    m_dataLength = 0;
+    m_raw = false;
+    m_writing = true;
+
+    return writeHeader(0);
+}
+
+/**
+ * @brief Writes the current data length to the header, so the file is valid even if it is
+ * never closed properly
+ */
+bool WavFile::updateHeader()
+{
+    if (!m_writing)
+        return false;
+
+    const qint64 position = pos();
+    m_dataLength = qMax(m_dataLength, position - 44);
+    if (!seek(0) || !writeHeader(m_dataLength))
+        return false;
+
+    return seek(position);
+}
+
+void WavFile::close()
+{
+    if (isOpen() && m_writing) {
+        updateHeader();
+        m_writing = false;
+    }
+
+    QFile::close();
+}
+
+bool WavFile::writeHeader(qint64 dataLength)
+{
+    const quint16 formatTag = m_format.sampleType() == QAudioFormat::Float ? WaveFormatFloat : WaveFormatPcm;
+    const quint16 channels = m_format.channelCount();
+    const quint16 blockAlign = channels * (m_format.sampleSize() / 8);
+
+    uchar header[44];
+    memcpy(header, "RIFF", 4);
+    qToLittleEndian<quint32>(quint32(36 + dataLength), header + 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, header + 16);
+    qToLittleEndian<quint16>(formatTag, header + 20);
+    qToLittleEndian<quint16>(channels, header + 22);
+    qToLittleEndian<quint32>(m_format.sampleRate(), header + 24);
+    qToLittleEndian<quint32>(m_format.sampleRate() * blockAlign, header + 28);
+    qToLittleEndian<quint16>(blockAlign, header + 32);
+    qToLittleEndian<quint16>(m_format.sampleSize(), header + 34);
+    memcpy(header + 36, "data", 4);
+    qToLittleEndian<quint32>(quint32(dataLength), header + 40);
+
+    return write(reinterpret_cast<const char*>(header), 44) == 44;
+}
+
+bool WavFile::readHeader()
+{
+    char riff[12];
+    if (read(riff, 12) != 12 || memcmp(riff + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool hasFormat = false;
+    forever {
+        char chunk[8];
+        if (read(chunk, 8) != 8)
+            return false;
+
+        const qint64 chunkSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(chunk + 4));
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkSize < 16)
+                return false;
+
+            QByteArray fmt = read(chunkSize + (chunkSize & 1));
+            if (fmt.size() < 16)
+                return false;
+
+            const uchar* ptr = reinterpret_cast<const uchar*>(fmt.constData());
+            quint16 formatTag = qFromLittleEndian<quint16>(ptr);
+            const int channels = qFromLittleEndian<quint16>(ptr + 2);
+            const int sampleRate = qFromLittleEndian<quint32>(ptr + 4);
+            const int bitsPerSample = qFromLittleEndian<quint16>(ptr + 14);
+
+            // the extensible format stores the actual format in the sub format GUID
+            if (formatTag == WaveFormatExtensible && fmt.size() >= 26)
+                formatTag = qFromLittleEndian<quint16>(ptr + 24);
+
+            m_format = QAudioFormat();
+            m_format.setCodec("audio/pcm");
+            m_format.setByteOrder(QAudioFormat::LittleEndian);
+            m_format.setChannelCount(channels);
+            m_format.setSampleRate(sampleRate);
+            m_format.setSampleSize(bitsPerSample);
+
+            if (formatTag == WaveFormatFloat)
+                m_format.setSampleType(QAudioFormat::Float);
+            else if (formatTag == WaveFormatPcm)
+                m_format.setSampleType(bitsPerSample == 8 ? QAudioFormat::UnSignedInt : QAudioFormat::SignedInt);
+            else
+                return false;
+
+            hasFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            // the data chunk size may be unset if the recording has not been finished properly
+            m_dataLength = qMin(chunkSize, size() - pos());
+            if (m_dataLength == 0)
+                m_dataLength = size() - pos();
+
+            return hasFormat && m_format.isValid();
+        }
+        else {
+            // skip unknown chunks, chunks are padded to an even size
+            if (!seek(pos() + chunkSize + (chunkSize & 1)))
+                return false;
+        }
+    }
+
+    return false;
+}
+
+const QAudioFormat& WavFile::getFormat() const
+{
+    return m_format;
+}
+
+/**
+ * @brief Returns the length of the audio data in bytes
+ */
+qint64 WavFile::getDataLength() const
+{
+    return m_dataLength;
+}
+
+bool WavFile::isRaw() const
+{
+    return m_raw;
+}
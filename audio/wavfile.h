@@ -0,0 +1,69 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <QFile>
+#include <QAudioFormat>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The WavFile class reads and writes PCM audio as RIFF/WAVE files. Files without a RIFF
+ * header are treated as raw PCM data in a format given by the caller. After opening, the file is
+ * positioned at the first audio frame and reads and writes transfer plain PCM data.
+ */
+class WavFile
+        : public QFile
+{
+public:
+    WavFile(const QString& fileName, QObject* parent = 0);
+    ~WavFile();
+
+    bool openRead(const QAudioFormat& rawFormat = QAudioFormat());
+    bool openWrite(const QAudioFormat& format);
+    bool updateHeader();
+    void close();
+
+    const QAudioFormat& getFormat() const;
+    qint64 getDataLength() const;
+    bool isRaw() const;
+
+private:
+    bool readHeader();
+    bool writeHeader(qint64 dataLength);
+
+    QAudioFormat m_format;
+    qint64 m_dataLength;
+    bool m_raw;
+    bool m_writing;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // WAVFILE_H
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# Compares the FFT backends for the transform sizes used by QtRTTY
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = fftbenchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+ROOT = $$_PRO_FILE_PWD_/../..
+
+SOURCES += main.cpp \
+    $$ROOT/signalprocessing/builtinfftbackend.cpp \
+    $$ROOT/signalprocessing/fftbackend.cpp
+
+HEADERS += $$ROOT/signalprocessing/builtinfftbackend.h \
+    $$ROOT/signalprocessing/fftbackend.h
+
+INCLUDEPATH += $$ROOT/external/include
+
+!builtin_fft {
+    DEFINES += HAVE_FFTW
+    SOURCES += $$ROOT/signalprocessing/fftwbackend.cpp
+    HEADERS += $$ROOT/signalprocessing/fftwbackend.h
+    win32: LIBS += $$ROOT/external/bin/libfftw3-3.dll
+    else: LIBS += -lfftw3
+}
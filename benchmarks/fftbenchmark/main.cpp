@@ -0,0 +1,153 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "../../signalprocessing/fftbackend.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <cmath>
+#include <cstdlib>
+
+using namespace Digital::Internal;
+
+namespace {
+
+const int SIZES[] = { 512, 1024, 2048, 4096, 8192 };
+const int NUM_SIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+const qint64 MIN_DURATION_NS = 200000000;
+
+struct Result {
+    Result() : nsPerTransform(0), mflops(0) {}
+    double nsPerTransform;
+    double mflops;
+    QVector<double> output;     // for the comparison between backends
+};
+
+void executeOnce(const FFT* fft, const double* in, FFTComplex* out)
+{
+    if (fft->getType() == FFT::TYPE_REAL)
+        fft->execute(in, out);
+    else
+        fft->execute((const FFTComplex*)in, out);
+}
+
+/**
+ * @brief Runs a transform repeatedly until the minimum duration is reached
+ */
+Result measure(FFTBackend* backend, FFT::Type type, int size)
+{
+    Result result;
+    FFT* fft = backend->createFFT(type, size, FFTBackend::EFFORT_MEASURE);
+    if (!fft)
+        return result;
+
+    // the input is large enough for the complex transforms, the same seed gives every
+    // backend the same data
+    double* in = (double*)FFT::allocate(sizeof(FFTComplex) * size);
+    FFTComplex* out = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * size);
+    srand(size);
+    for (int i = 0; i < 2 * size; i++)
+        in[i] = (double)rand() / RAND_MAX - 0.5;
+
+    executeOnce(fft, in, out);
+
+    const int bins = type == FFT::TYPE_REAL ? size / 2 + 1 : size;
+    result.output.resize(2 * bins);
+    for (int i = 0; i < bins; i++) {
+        result.output[2 * i] = out[i][0];
+        result.output[2 * i + 1] = out[i][1];
+    }
+
+    qint64 iterations = 0;
+    qint64 elapsed = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int repeat = 16; elapsed < MIN_DURATION_NS; repeat *= 2) {
+        for (int i = 0; i < repeat; i++)
+            executeOnce(fft, in, out);
+        iterations += repeat;
+        elapsed = timer.nsecsElapsed();
+    }
+
+    // the usual figure of 5 N log2(N) flops for complex and half of it for real transforms
+    double flops = 5.0 * size * log((double)size) / log(2.0);
+    if (type == FFT::TYPE_REAL)
+        flops /= 2;
+    result.nsPerTransform = (double)elapsed / iterations;
+    result.mflops = flops / result.nsPerTransform * 1000.0;
+
+    FFT::release(in);
+    FFT::release(out);
+    delete fft;
+    return result;
+}
+
+double maxDifference(const QVector<double>& a, const QVector<double>& b)
+{
+    double diff = 0;
+    for (int i = 0; i < a.size() && i < b.size(); i++)
+        diff = qMax(diff, qAbs(a[i] - b[i]));
+    return diff;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList names = FFTBackend::getNames();
+    QList<FFTBackend*> backends;
+    foreach (const QString& name, names)
+        backends.append(FFTBackend::create(name));
+
+    const FFT::Type types[] = { FFT::TYPE_FORWARD, FFT::TYPE_REAL };
+    const char* typeNames[] = { "complex", "real" };
+
+    out << "type     size  backend       ns/fft    mflops   max diff to " << names.first() << endl;
+    for (int t = 0; t < 2; t++) {
+        for (int s = 0; s < NUM_SIZES; s++) {
+            QList<Result> results;
+            foreach (FFTBackend* backend, backends)
+                results.append(measure(backend, types[t], SIZES[s]));
+
+            for (int b = 0; b < backends.size(); b++) {
+                out << qSetFieldWidth(7) << left << typeNames[t]
+                    << qSetFieldWidth(6) << right << SIZES[s] << qSetFieldWidth(0) << "  "
+                    << qSetFieldWidth(10) << left << names[b] << qSetFieldWidth(11) << right
+                    << qSetRealNumberPrecision(0) << fixed << results[b].nsPerTransform
+                    << qSetFieldWidth(10) << results[b].mflops
+                    << qSetFieldWidth(15) << qSetRealNumberPrecision(2) << scientific
+                    << maxDifference(results[b].output, results.first().output)
+                    << qSetFieldWidth(0) << endl;
+            }
+        }
+    }
+
+    qDeleteAll(backends);
+    return 0;
+}
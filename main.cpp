@@ -1,11 +1,70 @@
 #include "mainwindow.h"
+#include "signalprocessing/fftplancache.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption rxFileOption("rx-file",
+        "Decode a WAV or raw PCM recording instead of a soundcard input.", "file");
+    QCommandLineOption realTimeOption("realtime",
+        "Play back the recording at its sample rate instead of as fast as possible.");
+    QCommandLineOption txFileOption("tx-file",
+        "Render the transmitted audio into a WAV file instead of a soundcard output.", "file");
+    QCommandLineOption backendOption("fft-backend",
+        "FFT implementation: " + Digital::Internal::FFTBackend::getNames().join(", ") +
+        " (default " + Digital::Internal::FFTBackend::getDefaultName() + ").", "name");
+    QCommandLineOption planningOption("fft-planning",
+        "Planning effort for FFTs in the background: estimate, measure (default) or patient.",
+        "effort", "measure");
+    parser.addOption(rxFileOption);
+    parser.addOption(realTimeOption);
+    parser.addOption(txFileOption);
+    parser.addOption(backendOption);
+    parser.addOption(planningOption);
+    parser.process(a);
+
+    Digital::Internal::FFTPlanCache& fftPlans = Digital::Internal::FFTPlanCache::instance();
+    if (parser.isSet(backendOption)) {
+        Digital::Internal::FFTBackend* backend =
+                Digital::Internal::FFTBackend::create(parser.value(backendOption));
+        if (backend)
+            fftPlans.setBackend(backend);
+        else
+            qWarning() << "unknown FFT backend" << parser.value(backendOption);
+    }
+
+    // FFT plans are measured in the background, wisdom from earlier runs makes the
+    // estimated plans at startup just as fast
+    const QString wisdomPath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+    const QString wisdomFile = wisdomPath + "/" + fftPlans.getBackendName() + ".wisdom";
+    fftPlans.importWisdom(wisdomFile);
+
+    const QString planning = parser.value(planningOption);
+    if (planning == "patient")
+        fftPlans.startBackgroundPlanning(Digital::Internal::FFTBackend::EFFORT_PATIENT);
+    else if (planning != "estimate")
+        fftPlans.startBackgroundPlanning(Digital::Internal::FFTBackend::EFFORT_MEASURE);
+
     MainWindow w;
+    if (parser.isSet(rxFileOption))
+        w.addInputFile(parser.value(rxFileOption), parser.isSet(realTimeOption));
+    if (parser.isSet(txFileOption))
+        w.addOutputFile(parser.value(txFileOption));
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+
+    fftPlans.stopBackgroundPlanning();
+    if (QDir().mkpath(wisdomPath))
+        fftPlans.exportWisdom(wisdomFile);
+
+    return result;
 }
@@ -13,6 +13,13 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->setupUi(this);
 
     m_modem = new ModemRTTY(this);
+
+    // the modem metric is read from the band power of the input spectrum
+    m_spectrum = new FFTSpectrum(2048, 512, WT_BLACKMAN, this);
+    m_spectrum->setOutputs(OUTPUT_BAND_POWER);
+    m_spectrum->init();
+    m_modem->setBandPower(m_spectrum->getBandPower());
+
     //connect(m_modem, &Modem::received, this, &MainWindow::characterReceived);
     //connect(m_modem, &Modem::sent, this, &MainWindow::characterSent);
 
@@ -48,6 +55,36 @@ MainWindow::MainWindow(QWidget *parent) :
 MainWindow::~MainWindow()
 {
     delete m_modem;
+
+    if (m_inDevice)
+        m_inDevice->unregisterConsumer(m_spectrum);
+    delete m_spectrum;
+}
+
+void MainWindow::addInputFile(const QString& fileName, bool realTime)
+{
+    // remove the placeholder if no soundcard has been found
+    if (m_deviceList.getInputDevices().isEmpty())
+        ui->cbInputDevices->clear();
+
+    AudioDeviceIn* device = m_deviceList.addInputFile(fileName, realTime);
+
+    ui->cbInputDevices->setEnabled(true);
+    ui->cbInputDevices->addItem(device->getDeviceName());
+    ui->cbInputDevices->setCurrentIndex(ui->cbInputDevices->count() - 1);
+}
+
+void MainWindow::addOutputFile(const QString& fileName)
+{
+    // remove the placeholder if no soundcard has been found
+    if (m_deviceList.getOutputDevices().isEmpty())
+        ui->cbOutputDevices->clear();
+
+    AudioDeviceOut* device = m_deviceList.addOutputFile(fileName);
+
+    ui->cbOutputDevices->setEnabled(true);
+    ui->cbOutputDevices->addItem(device->getDeviceName());
+    ui->cbOutputDevices->setCurrentIndex(ui->cbOutputDevices->count() - 1);
 }
 
 void MainWindow::on_pbStartInput_clicked()
@@ -74,6 +111,7 @@ void MainWindow::on_cbInputDevices_currentIndexChanged(int index)
         return;
 
     if (m_inDevice) {
+        m_inDevice->unregisterConsumer(m_spectrum);
         m_inDevice->close();
     }
 
@@ -86,6 +124,7 @@ void MainWindow::on_cbInputDevices_currentIndexChanged(int index)
         m_inDevice->setSampleSize(16);
     }
     m_inDevice->init();
+    m_inDevice->registerConsumer(m_spectrum);
 
     m_modem->init(m_inDevice, m_outDevice);
 
@@ -10,6 +10,7 @@
 #include "modems/modemreceiver.h"
 #include "modems/modemtransmitter.h"
 #include "modems/modemrtty.h"
+#include "signalprocessing/fftspectrum.h"
 
 namespace Ui {
 class MainWindow;
@@ -25,6 +26,9 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
+    void addInputFile(const QString& fileName, bool realTime);
+    void addOutputFile(const QString& fileName);
+
 private slots:
     void on_pbStartInput_clicked();
     void on_pbStopInput_clicked();
@@ -45,6 +49,7 @@ private:
     AudioDeviceIn*      m_inDevice;
     AudioDeviceOut*     m_outDevice;
     ModemRTTY*          m_modem;
+    FFTSpectrum*        m_spectrum;
 };
 
 #endif // MAINWINDOW_H
@@ -37,24 +37,26 @@ using namespace Digital::Internal;
 
 Modem::Modem(unsigned capability, QObject* parent)
     : QObject(parent),
+      m_thread(0),
+      m_hasInputData(false),
+      m_deviceIn(0),
+      m_deviceOut(0),
+      m_receiver(0),
+      m_transmitter(0),
+      m_hasNextCharacter(false),
+      m_nextCharacter(0),
+      m_autoMode(false),
       m_capability(capability),
+      m_metric(0),
+      m_squelch(0),
+      m_bandPower(0),
       m_frequency(1000),
       m_afcSpeed(AFC_NORMAL),
       m_freqErr(0),
       m_afc(true),
       m_reverse(false),
       m_internalState(INTSTATE_PREINIT),
-      m_requestedState(INTSTATE_PREINIT),
-      m_hasInputData(false),
-      m_deviceIn(0),
-      m_deviceOut(0),
-      m_receiver(0),
-      m_transmitter(0),
-      m_thread(0),
-      m_metric(0),
-      m_nextCharacter(0),
-      m_hasNextCharacter(false),
-      m_autoMode(false)
+      m_requestedState(INTSTATE_PREINIT)
 {
     m_baseThread = thread();
 }
@@ -158,9 +160,11 @@ void Modem::shutdown()
     if (isReceiving())
         stopRx();
 
+    m_waitMutex.lock();
     setInternalState(INTSTATE_SHUTDOWN);
-
     m_waitForData.wakeAll();
+    m_waitMutex.unlock();
+
     m_thread->quit();
     m_thread->wait();
 
@@ -187,7 +191,10 @@ void Modem::shutdown()
     }
 
     iShutdown();
+
+    m_waitMutex.lock();
     setInternalState(INTSTATE_PREINIT);
+    m_waitMutex.unlock();
 
     emit initialized(false);
 }
@@ -240,7 +247,9 @@ void Modem::adjustFrequency(double frqerr)
 void Modem::process()
 {
     // signal that the thread started running
+    m_waitMutex.lock();
     setInternalState(INTSTATE_READY);
+    m_waitMutex.unlock();
 
     while (m_internalState != INTSTATE_SHUTDOWN) {
         QCoreApplication::processEvents();
@@ -260,6 +269,7 @@ void Modem::process()
             m_metric = computeMetric();
 
             m_hasInputData = false;
+            m_inputConsumed.wakeAll();
             break;
         case INTSTATE_TX_STARTING:
         case INTSTATE_TX_STOPPING:
@@ -379,10 +389,14 @@ bool Modem::startRx()
 void Modem::receive(const QVector<double>& data)
 {
     QMutexLocker lock(&m_waitMutex);
-    if (m_internalState == INTSTATE_RX) {
-        if (m_hasInputData)
-            return;
 
+    // Wait until the previous block has been processed. This is called from the receiver's
+    // processing thread, so further blocks are queued in the receiver meanwhile. State changes
+    // also wake this condition, they happen with m_waitMutex held.
+    while (m_hasInputData && m_internalState == INTSTATE_RX)
+        m_inputConsumed.wait(&m_waitMutex);
+
+    if (m_internalState == INTSTATE_RX) {
         m_inputBlock = data;
         m_waitForData.wakeAll();
         m_hasInputData = true;
@@ -438,6 +452,19 @@ bool Modem::writeSample(double sample)
     return true;
 }
 
+/**
+ * @brief Writes a block of samples, which is much cheaper than writing each sample on its own
+ */
+bool Modem::writeSamples(const double* samples, int count)
+{
+    if (!isTransmitting()|| !m_transmitter)
+        return false;
+
+    m_transmitter->writeValues(samples, count);
+
+    return true;
+}
+
 double Modem::getFrqErr() const
 {
     return m_freqErr;
@@ -476,6 +503,10 @@ Modem::InternalState Modem::getInternalState() const
     return m_internalState;
 }
 
+/**
+ * @brief Changes the state and wakes everybody waiting for it. Must be called with m_waitMutex
+ * held, so a thread waiting in receive() cannot miss the change between its check and its wait.
+ */
 void Modem::setInternalState(Modem::InternalState state)
 {
     m_stateChangedMutex.lock();
@@ -484,10 +515,39 @@ void Modem::setInternalState(Modem::InternalState state)
     m_requestedState = state;
 
     m_stateChangedCond.wakeAll();
+    m_inputConsumed.wakeAll();
     m_stateChangedMutex.unlock();
 }
 
-double Modem::isSquelchOpen() const
+/**
+ * @brief Sets the metric the signal must exceed before received characters are passed on,
+ * 0 disables the squelch
+ */
+void Modem::setSquelch(double squelch)
 {
-    return true;
+    m_squelch = squelch;
+}
+
+double Modem::getSquelch() const
+{
+    return m_squelch;
+}
+
+bool Modem::isSquelchOpen() const
+{
+    return m_squelch <= 0 || m_metric > m_squelch;
+}
+
+/**
+ * @brief Sets the band power index of a spectrum of the input audio, which modems use to
+ * compute their metric without transforms of their own
+ */
+void Modem::setBandPower(const BandPower* bandPower)
+{
+    m_bandPower = bandPower;
+}
+
+const BandPower* Modem::getBandPower() const
+{
+    return m_bandPower;
 }
@@ -45,6 +45,7 @@ class ModemReceiver;
 class ModemTransmitter;
 class AudioDeviceIn;
 class AudioDeviceOut;
+class BandPower;
 
 class Modem
         : public QObject
@@ -87,6 +88,8 @@ public:
     void            setAFCSpeed(AFCSpeed);
     bool            setAFC(bool);
     bool            setReverse(bool);
+    void            setSquelch(double);
+    void            setBandPower(const BandPower*);
     bool            isTransmitting() const;
     bool            isReceiving() const;
 
@@ -97,7 +100,8 @@ public:
     AFCSpeed        getAFCSpeed() const;
     bool            getAFC() const;
     bool            isReverse() const;
-    double          isSquelchOpen() const; // metric > squelch ? true : false
+    double          getSquelch() const;
+    bool            isSquelchOpen() const; // metric > squelch ? true : false
 
 public slots:
     void process();
@@ -150,14 +154,16 @@ protected:
     virtual void    iShutdown() = 0;
     virtual void    iRxProcess(const QVector<double>&) = 0;
     virtual void    iTxProcess() = 0;
-    virtual double  computeMetric() const = 0;
+    virtual double  computeMetric() = 0;
     bool            getNextChar(QChar&);
     bool            writeSample(double);
+    bool            writeSamples(const double*, int);
     InternalState   getInternalState() const;
 
     double          getFrqErr() const;
     void            adjustFrequency(double);   // AFC
     int             getSampleRate() const;
+    const BandPower* getBandPower() const;
 
 private:
     void setInternalState(InternalState);
@@ -165,6 +171,7 @@ private:
     QThread*        m_baseThread;
     QMutex          m_waitMutex;
     QWaitCondition  m_waitForData;
+    QWaitCondition  m_inputConsumed;
     QThread*        m_thread;
     QMutex          m_extMutex;
     QWaitCondition  m_extWaitCond;
@@ -190,6 +197,8 @@ private:
     QAudioFormat    m_format;
     unsigned        m_capability;
     double          m_metric;
+    double          m_squelch;      // 0 keeps the squelch open
+    const BandPower* m_bandPower;   // spectrum of the input, 0 if there is none
     double          m_frequency;
     AFCSpeed        m_afcSpeed;
     double          m_freqErr;
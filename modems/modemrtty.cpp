@@ -24,11 +24,104 @@
 
 #include "modemrtty.h"
 #include "../signalprocessing/misc.h"
+#include "../signalprocessing/bandpower.h"
 #include <math.h>
 #include <QDebug>
 
 using namespace Digital::Internal;
 
+namespace {
+
+// The ATC demodulators are described here: http://www.w7ay.net/site/Technical/ATC/
+// Each variant is a specialization of atcValue(), and atcKernel() applies it to a whole block
+// of envelopes. All conditions are written as selects so the kernels are free of branches.
+
+inline double clipEnvelope(double mag, double env, double noiseFloor)
+{
+    const double clipped = mag < noiseFloor ? noiseFloor : mag;
+    return mag > env ? env : clipped;
+}
+
+template <int D>
+inline double atcValue(double markMag, double spaceMag, double, double, double)
+{
+    // DEMOD_NO_ATC
+    return markMag - spaceMag;
+}
+
+template <>
+inline double atcValue<ModemRTTY::DEMOD_LINEAR_ATC>(double markMag, double spaceMag,
+                                                    double markEnv, double spaceEnv, double)
+{
+    return markMag - spaceMag - 0.5 * (markEnv - spaceEnv);
+}
+
+template <>
+inline double atcValue<ModemRTTY::DEMOD_CLIPPED_ATC>(double markMag, double spaceMag,
+                                                     double markEnv, double spaceEnv, double noiseFloor)
+{
+    markMag = clipEnvelope(markMag, markEnv, noiseFloor);
+    spaceMag = clipEnvelope(spaceMag, spaceEnv, noiseFloor);
+    return (markMag - noiseFloor) - (spaceMag - noiseFloor) - 0.5 * (
+            (markEnv - noiseFloor) - (spaceEnv - noiseFloor));
+}
+
+template <>
+inline double atcValue<ModemRTTY::DEMOD_OPTIMAL_ATC>(double markMag, double spaceMag,
+                                                     double markEnv, double spaceEnv, double noiseFloor)
+{
+    markMag = clipEnvelope(markMag, markEnv, noiseFloor);
+    spaceMag = clipEnvelope(spaceMag, spaceEnv, noiseFloor);
+    return (markMag - noiseFloor) * (markEnv - noiseFloor) -
+            (spaceMag - noiseFloor) * (spaceEnv - noiseFloor) - 0.5 * (
+            (markEnv - noiseFloor) * (markEnv - noiseFloor) -
+            (spaceEnv - noiseFloor) * (spaceEnv - noiseFloor));
+}
+
+template <>
+inline double atcValue<ModemRTTY::DEMOD_KAHN_LINEAR_ATC>(double markMag, double spaceMag,
+                                                         double markEnv, double spaceEnv, double noiseFloor)
+{
+    return (markMag - noiseFloor) * (markMag - noiseFloor) -
+            (spaceMag - noiseFloor) * (spaceMag - noiseFloor) - 0.25 * (
+            (markEnv - noiseFloor) * (markEnv - noiseFloor) -
+            (spaceEnv - noiseFloor) * (spaceEnv - noiseFloor));
+}
+
+template <>
+inline double atcValue<ModemRTTY::DEMOD_KAHN_CLIPPED_ATC>(double markMag, double spaceMag,
+                                                          double markEnv, double spaceEnv, double noiseFloor)
+{
+    markMag = clipEnvelope(markMag, markEnv, noiseFloor);
+    spaceMag = clipEnvelope(spaceMag, spaceEnv, noiseFloor);
+    return atcValue<ModemRTTY::DEMOD_KAHN_LINEAR_ATC>(markMag, spaceMag, markEnv, spaceEnv, noiseFloor);
+}
+
+typedef void (*AtcKernel)(const double* markMag, const double* spaceMag,
+                          const double* markEnv, const double* spaceEnv,
+                          const double* noiseFloor, double* value, int count);
+
+template <int D>
+void atcKernel(const double* markMag, const double* spaceMag,
+               const double* markEnv, const double* spaceEnv,
+               const double* noiseFloor, double* value, int count)
+{
+    for (int j = 0; j < count; j++)
+        value[j] = atcValue<D>(markMag[j], spaceMag[j], markEnv[j], spaceEnv[j], noiseFloor[j]);
+}
+
+// indexed by ModemRTTY::Demodulator
+const AtcKernel ATC_KERNELS[] = {
+    atcKernel<ModemRTTY::DEMOD_LINEAR_ATC>,
+    atcKernel<ModemRTTY::DEMOD_CLIPPED_ATC>,
+    atcKernel<ModemRTTY::DEMOD_OPTIMAL_ATC>,
+    atcKernel<ModemRTTY::DEMOD_KAHN_LINEAR_ATC>,
+    atcKernel<ModemRTTY::DEMOD_KAHN_CLIPPED_ATC>,
+    atcKernel<ModemRTTY::DEMOD_NO_ATC>
+};
+
+} // namespace
+
 const char ModemRTTY::LETTERS[32] = {
     '\0',	'E',	'\n',	'A',	' ',	'S',	'I',	'U',
     '\r',	'D',	'R',	'J',	'N',	'F',	'C',	'K',
@@ -44,11 +137,32 @@ const char ModemRTTY::FIGURES[32] = {
 const double ModemRTTY::SHIFTS[] = {23, 85, 160, 170, 182, 200, 240, 350, 425, 850};
 const double ModemRTTY::BAUDS[]  = {45, 45.45, 50, 56, 75, 100, 110, 150, 200, 300};
 const int    ModemRTTY::BITS[]  = {5, 7, 8};
+const int    ModemRTTY::MIN_SYMBOL_SAMPLES = 32;
+const int    ModemRTTY::FILTER_LENGTH = 1024;
+const int    ModemRTTY::MIN_BLOCK_SIZE = 32;
+
+// order in which ties of the diversity vote are resolved
+const ModemRTTY::Demodulator ModemRTTY::VOTE_ORDER[] = {
+    DEMOD_OPTIMAL_ATC,
+    DEMOD_CLIPPED_ATC,
+    DEMOD_KAHN_CLIPPED_ATC,
+    DEMOD_LINEAR_ATC,
+    DEMOD_KAHN_LINEAR_ATC,
+    DEMOD_NO_ATC
+};
 
 ModemRTTY::ModemRTTY(QObject* parent)
     : Modem(CAP_TX | CAP_RX | CAP_AFC | CAP_REV, parent),
-      m_markFilter(0),
-      m_spaceFilter(0)
+      m_demodulator(DEMOD_NO_ATC),
+      m_decimation(0),
+      m_blockSize(0),
+      m_filter(0),
+      m_sigPwr(0),
+      m_noisePwr(0),
+      m_metricFrame(-1),
+      m_lastMetric(0),
+      m_voteCountdown(0),
+      m_activeDemodulator(DEMOD_NO_ATC)
 {
 }
 
@@ -56,12 +170,9 @@ ModemRTTY::~ModemRTTY()
 {
     shutdown();
 
-    delete m_markFilter;
-    delete m_spaceFilter;
+    delete m_filter;
     delete m_symShaperMark;
     delete m_symShaperSpace;
-    delete m_oscMark;
-    delete m_oscSpace;
 }
 
 QString ModemRTTY::getTypeStatic()
@@ -122,9 +233,17 @@ void ModemRTTY::setStopBits(StopBits stop)
         restart();
 }
 
+/**
+ * @brief Selects the ATC demodulator. This may be called while receiving, the receiver picks
+ * up the new demodulator with the next block. DEMOD_DIVERSITY runs all demodulators, each with
+ * its own bit synchronizer, and decides each character by a vote.
+ */
 void ModemRTTY::setDemodulator(Demodulator demodulator)
 {
-    m_demodulator = demodulator;
+    if (demodulator < DEMOD_LINEAR_ATC || demodulator > DEMOD_DIVERSITY)
+        demodulator = DEMOD_NO_ATC;
+
+    m_demodulator.storeRelease(demodulator);
 }
 
 void ModemRTTY::setUnshiftOnSpace(bool unshiftOnSpace)
@@ -132,13 +251,48 @@ void ModemRTTY::setUnshiftOnSpace(bool unshiftOnSpace)
     m_unshiftOnSpace = unshiftOnSpace;
 }
 
+/**
+ * @brief Sets the factor by which the mark and space channels are decimated after filtering.
+ * A factor of 0 selects the largest factor that keeps MIN_SYMBOL_SAMPLES samples per symbol.
+ * The factor is rounded down to a divisor of the filter block size.
+ */
+void ModemRTTY::setDecimation(int decimation)
+{
+    if (decimation < 0)
+        decimation = 0;
+
+    m_decimation = decimation;
+
+    if (getInternalState() != INTSTATE_PREINIT)
+        restart();
+}
+
+/**
+ * @brief Sets the number of samples after which the mark and space filters deliver output.
+ * Half the filter length or more runs the filters with overlap-add, smaller blocks use
+ * partitioned convolution, which lowers the latency of decoding and AFC at a higher CPU
+ * cost. A size of 0 selects overlap-add, smaller sizes are raised to MIN_BLOCK_SIZE samples.
+ * Half a symbol keeps the bit decisions and the AFC close to the signal. The size is rounded
+ * down to a divisor of half the filter length.
+ */
+void ModemRTTY::setBlockSize(int blockSize)
+{
+    if (blockSize < 0)
+        blockSize = 0;
+
+    m_blockSize = blockSize;
+
+    if (getInternalState() != INTSTATE_PREINIT)
+        restart();
+}
+
 bool ModemRTTY::iInit()
 {
     m_symShaperMark = new SymbolShaper(45, getSampleRate());    // what about m_baud?
     m_symShaperSpace = new SymbolShaper(45, getSampleRate());
 
-    m_oscMark = new Oscillator(getSampleRate());
-    m_oscSpace = new Oscillator(getSampleRate());
+    m_oscMark.setSampleRate(getSampleRate());
+    m_oscSpace.setSampleRate(getSampleRate());
 
     // set defaults
     setShift(SHIFTS[3]);
@@ -149,8 +303,6 @@ bool ModemRTTY::iInit()
     setDemodulator(DEMOD_OPTIMAL_ATC);
     setUnshiftOnSpace(true);
 
-    m_rxState = RXSTATE_IDLE;
-
     return true;
 }
 
@@ -164,11 +316,24 @@ void ModemRTTY::iRestart()
     m_rxMode = MODE_LETTERS;
     m_txMode = MODE_LETTERS;
 
-    m_symbolLen = (int)(getSampleRate() / m_baud + 0.5);
-    m_bitBuf.resize(m_symbolLen);
-    m_bitBuf.assign(m_bitBuf.size(), false);
+    m_txSymbolLen = (int)(getSampleRate() / m_baud + 0.5);
 
+    // The filtered mark and space signals are only about as wide as the baud rate, so the
+    // demodulator runs at a fraction of the sample rate. All symbol related lengths of the
+    // receiver are counted in decimated samples.
     resetFilters();
+    m_rxDecimation = m_filter->getDecimation();
+    m_rxSampleRate = m_filter->getOutputRate();
+    m_symbolLen = (int)(m_rxSampleRate / m_baud + 0.5);
+
+    // the bit sync tolerance was 6 samples at the full rate
+    m_syncTolerance = (6 + m_rxDecimation - 1) / m_rxDecimation;
+
+    for (int i = 0; i < NUM_ATC; i++) {
+        m_syncs[i].reset(m_symbolLen);
+        m_votes[i] = -1;
+    }
+    m_voteCountdown = 0;
 
     double stop = 2.0;
     if (m_stopBits == STOP_1)
@@ -180,10 +345,12 @@ void ModemRTTY::iRestart()
 
     m_stopLen = (int)(stop * getSampleRate() / m_baud + 0.5);
 
-    m_markPhase = m_spacePhase = 0;
     m_markNoise = m_spaceNoise = 0;
     m_markEnv = m_spaceEnv = 0;
     m_prevMark = m_prevSpace = std::complex<double>(0, 0);
+    m_sigPwr = m_noisePwr = 0;
+    m_metricFrame = -1;
+    m_lastMetric = 0;
 
     m_lastChar = 0;
 }
@@ -193,115 +360,159 @@ void ModemRTTY::iRxProcess(const QVector<double>& buffer)
     if (buffer.isEmpty())
         return;
 
-    std::complex<double> z, zmark, zspace, *zp_mark, *zp_space;
-
-    for (int i = 0; i < buffer.size(); i++) {
-        // Create analytic signal from sound card input samples
-        z = std::complex<double>(buffer[i], buffer[i]);
-
-        // Mix it with the audio carrier frequency to create two baseband signals
-        // mark and space that are separated and processed independently.
-        // lowpass Windowed Sinc - Overlap-Add convolution filters.
-        // The two fftfilt's are the same size and processed in sync
-        // therefore the mark and space filters will concurrently have the
-        // same size outputs available for further processing
-
-        double markFrq = getFrequency() + m_shift / 2.0;
-        zmark = mix(m_markPhase, markFrq, z);
-        m_markFilter->run(zmark, &zp_mark);
-
-        double spaceFrq = getFrequency() - m_shift / 2.0;
-        zspace = mix(m_spacePhase, spaceFrq, z);
-        int n_out = m_spaceFilter->run(zspace, &zp_space);
-
-        for (int j = 0; j < n_out; j++) {
-            double markMag = abs(zp_mark[j]);
-            m_markEnv = decayAvg(m_markEnv, markMag,
-                                 (markMag > m_markEnv) ? m_symbolLen / 4 : m_symbolLen * 16);
-            m_markNoise = decayAvg(m_markNoise, markMag,
-                                   (markMag < m_markNoise) ? m_symbolLen / 4 : m_symbolLen * 48);
-
-            double spaceMag = abs(zp_space[j]);
-            m_spaceEnv = decayAvg(m_spaceEnv, spaceMag,
-                                  (spaceMag > m_spaceEnv) ? m_symbolLen / 4 : m_symbolLen * 16);
-            m_spaceNoise = decayAvg(m_spaceNoise, spaceMag,
-                                    (spaceMag < m_spaceNoise) ? m_symbolLen / 4 : m_symbolLen * 48);
-
-            // which one is better?
-            //double noiseFloor = std::min(m_spaceNoise, m_markNoise);  // found in fldigi
-            double noiseFloor = (m_spaceNoise + m_markNoise) / 2.0;     // described in the website below
-
-            const int cwi = 0;   // for debug purposes only
-            switch (cwi) {
-                case 1 : // mark only decode
-                    m_spaceEnv = noiseFloor;
-                    break;
-                case 2: // space only decode
-                    m_markEnv = noiseFloor;
-                default : ;
-            }
+    const int count = buffer.size();
+    const int maxOut = m_filter->getMaxOutput(count);
+    if (m_rxMarkOut.size() < maxOut) {
+        m_rxMarkOut.resize(maxOut);
+        m_rxSpaceOut.resize(maxOut);
+    }
 
-            // demodulators are described here: http://www.w7ay.net/site/Technical/ATC/
-            double value = 0;
-            switch (m_demodulator) {
-            case DEMOD_LINEAR_ATC:
-                value = markMag - spaceMag - 0.5 * (m_markEnv - m_spaceEnv);
-                break;
-            case DEMOD_CLIPPED_ATC:
-                markMag = markMag > m_markEnv ? m_markEnv : (markMag < noiseFloor ? noiseFloor : markMag);
-                spaceMag = spaceMag > m_spaceEnv ? m_spaceEnv : (spaceMag < noiseFloor ? noiseFloor : spaceMag);
-                value = (markMag - noiseFloor) - (spaceMag - noiseFloor) - 0.5 * (
-                        (m_markEnv - noiseFloor) - (m_spaceEnv - noiseFloor));
-                break;
-            case DEMOD_OPTIMAL_ATC:
-                markMag = markMag > m_markEnv ? m_markEnv : (markMag < noiseFloor ? noiseFloor : markMag);
-                spaceMag = spaceMag > m_spaceEnv ? m_spaceEnv : (spaceMag < noiseFloor ? noiseFloor : spaceMag);
-                value = (markMag - noiseFloor) * (m_markEnv - noiseFloor) -
-                        (spaceMag - noiseFloor) * (m_spaceEnv - noiseFloor) - 0.5 * (
-                        (m_markEnv - noiseFloor) * (m_markEnv - noiseFloor) -
-                        (m_spaceEnv - noiseFloor) * (m_spaceEnv - noiseFloor));
-                break;
-            case DEMOD_KAHN_LINEAR_ATC:
-                value = (markMag - noiseFloor) * (markMag - noiseFloor) -
-                        (spaceMag - noiseFloor) * (spaceMag - noiseFloor) - 0.25 * (
-                        (m_markEnv - noiseFloor) * (m_markEnv - noiseFloor) -
-                        (m_spaceEnv - noiseFloor) * (m_spaceEnv - noiseFloor));
-                break;
-            case DEMOD_KAHN_CLIPPED_ATC:
-                markMag = markMag > m_markEnv ? m_markEnv : (markMag < noiseFloor ? noiseFloor : markMag);
-                spaceMag = spaceMag > m_spaceEnv ? m_spaceEnv : (spaceMag < noiseFloor ? noiseFloor : spaceMag);
-                value = (markMag - noiseFloor) * (markMag - noiseFloor) -
-                        (spaceMag - noiseFloor) * (spaceMag - noiseFloor) - 0.25 * (
-                        (m_markEnv - noiseFloor) * (m_markEnv - noiseFloor) -
-                        (m_spaceEnv - noiseFloor) * (m_spaceEnv - noiseFloor));
-                break;
-            case DEMOD_NO_ATC: // No ATC
-            default :
-                value = markMag - spaceMag;
-            }
+    // The frequency is sampled once per block, AFC corrections apply to the next block.
+    const double frequency = getFrequency();
+    const double markFrq = frequency + m_shift / 2.0;
+    const double spaceFrq = frequency - m_shift / 2.0;
+
+    // Separate mark and space with a bank of two bandpass filters at the mark and space
+    // frequencies. The raised cosine FFT convolution filter is shifted to both
+    // frequencies, so one forward FFT of the input serves both channels. The
+    // filter bank returns both channels decimated and mixed down with the exact mark
+    // and space frequencies, as two baseband signals that are processed independently.
+    m_filter->setChannelFrequency(CHANNEL_MARK, markFrq);
+    m_filter->setChannelFrequency(CHANNEL_SPACE, spaceFrq);
 
-            bool bit = value > 0;
+    std::complex<double>* out[2] = { m_rxMarkOut.data(), m_rxSpaceOut.data() };
+    int n_out = m_filter->run(buffer.constData(), count, out);
+
+    demodulate(m_rxMarkOut.constData(), m_rxSpaceOut.constData(), n_out);
+}
+
+/**
+ * @brief Envelope detection, ATC, bit decision and AFC on a block of filtered mark and space
+ * samples
+ */
+void ModemRTTY::demodulate(const std::complex<double>* mark, const std::complex<double>* space, int count)
+{
+    const bool reverse = isReverse();
+    const int demodulator = m_demodulator.loadAcquire();
+    const bool diversity = demodulator == DEMOD_DIVERSITY;
+    const int rows = diversity ? NUM_ATC : 1;
+
+    // entering diversity mode, start all bit synchronizers from the current state and drop a
+    // vote that was still open when the mode was left
+    if (diversity && m_activeDemodulator != DEMOD_DIVERSITY) {
+        for (int i = 1; i < NUM_ATC; i++)
+            m_syncs[i] = m_syncs[0];
+        for (int i = 0; i < NUM_ATC; i++)
+            m_votes[i] = -1;
+        m_voteCountdown = 0;
+    }
+    m_activeDemodulator = demodulator;
+
+    if (m_rxMarkMag.size() < count) {
+        m_rxMarkMag.resize(count);
+        m_rxSpaceMag.resize(count);
+        m_rxMarkEnv.resize(count);
+        m_rxSpaceEnv.resize(count);
+        m_rxNoiseFloor.resize(count);
+    }
+    if (m_rxValue.size() < count * rows)
+        m_rxValue.resize(count * rows);
+
+    double* markMag = m_rxMarkMag.data();
+    double* spaceMag = m_rxSpaceMag.data();
+    double* markEnv = m_rxMarkEnv.data();
+    double* spaceEnv = m_rxSpaceEnv.data();
+    double* noiseFloor = m_rxNoiseFloor.data();
+    double* value = m_rxValue.data();
+
+    // envelope and noise tracking, each sample depends on the previous one
+    for (int j = 0; j < count; j++) {
+        markMag[j] = abs(mark[j]);
+        m_markEnv = decayAvg(m_markEnv, markMag[j],
+                             (markMag[j] > m_markEnv) ? m_symbolLen / 4 : m_symbolLen * 16);
+        m_markNoise = decayAvg(m_markNoise, markMag[j],
+                               (markMag[j] < m_markNoise) ? m_symbolLen / 4 : m_symbolLen * 48);
+
+        spaceMag[j] = abs(space[j]);
+        m_spaceEnv = decayAvg(m_spaceEnv, spaceMag[j],
+                              (spaceMag[j] > m_spaceEnv) ? m_symbolLen / 4 : m_symbolLen * 16);
+        m_spaceNoise = decayAvg(m_spaceNoise, spaceMag[j],
+                                (spaceMag[j] < m_spaceNoise) ? m_symbolLen / 4 : m_symbolLen * 48);
+
+        markEnv[j] = m_markEnv;
+        spaceEnv[j] = m_spaceEnv;
+
+        // which one is better?
+        //noiseFloor[j] = std::min(m_spaceNoise, m_markNoise);  // found in fldigi
+        noiseFloor[j] = (m_spaceNoise + m_markNoise) / 2.0;     // described in the website below
+    }
+
+    if (!diversity) {
+        // ATC demodulation of the whole block
+        ATC_KERNELS[demodulator](markMag, spaceMag, markEnv, spaceEnv, noiseFloor, value, count);
+
+        for (int j = 0; j < count; j++) {
+            bool bit = value[j] > 0;
 
             // detect TTY signal transitions
             // rx(...) returns true if valid TTY bit stream detected
             // either character or idle signal
-            bool reverse = isReverse();
-            if (rx(reverse ? !bit : bit)) {
-                double frqErr = (TWO_PI * getSampleRate() / m_baud) *
-                        (!reverse ?
-                            std::arg(std::conj(zp_mark[j]) * m_prevMark) :
-                            std::arg(std::conj(zp_space[j]) * m_prevSpace));
-
-                if (fabs(frqErr) > m_baud / 2)
-                    frqErr = 0;
-                else
-                    adjustFrequency(frqErr);
+            if (rx(m_syncs[0], reverse ? !bit : bit) && isSquelchOpen()) {
+                receive(m_syncs[0].rxData);
+                trackFrequency(mark[j], space[j], reverse);
             }
 
-            m_prevMark = zp_mark[j];
-            m_prevSpace = zp_space[j];
+            m_prevMark = mark[j];
+            m_prevSpace = space[j];
         }
-    };
+        return;
+    }
+
+    // All demodulators work on the same envelopes, row i of the values belongs to
+    // demodulator i.
+    for (int i = 0; i < NUM_ATC; i++)
+        ATC_KERNELS[i](markMag, spaceMag, markEnv, spaceEnv, noiseFloor, value + i * count, count);
+
+    for (int j = 0; j < count; j++) {
+        for (int i = 0; i < NUM_ATC; i++) {
+            bool bit = value[i * count + j] > 0;
+            if (rx(m_syncs[i], reverse ? !bit : bit)) {
+                m_votes[i] = m_syncs[i].rxData;
+
+                // the synchronizers finish the same character within a few samples, so
+                // the vote is held open for one symbol after the first one
+                if (m_voteCountdown == 0)
+                    m_voteCountdown = m_symbolLen;
+            }
+        }
+
+        if (m_voteCountdown > 0 && --m_voteCountdown == 0) {
+            int rxData = vote();
+            if (rxData >= 0 && isSquelchOpen()) {
+                receive(rxData);
+                trackFrequency(mark[j], space[j], reverse);
+            }
+        }
+
+        m_prevMark = mark[j];
+        m_prevSpace = space[j];
+    }
+}
+
+/**
+ * @brief Adjusts the frequency by the phase change of the active tone since the last sample
+ */
+void ModemRTTY::trackFrequency(const std::complex<double>& mark, const std::complex<double>& space, bool reverse)
+{
+    double frqErr = (TWO_PI * m_rxSampleRate / m_baud) *
+            (!reverse ?
+                std::arg(std::conj(mark) * m_prevMark) :
+                std::arg(std::conj(space) * m_prevSpace));
+
+    if (fabs(frqErr) > m_baud / 2)
+        frqErr = 0;
+    else
+        adjustFrequency(frqErr);
 }
 
 void ModemRTTY::iTxProcess()
@@ -313,12 +524,12 @@ void ModemRTTY::iTxProcess()
         m_symShaperSpace->reset();
 
         for (int i = 0; i < m_bits + 1; i++)
-            sendSymbol(0, m_symbolLen);
+            sendSymbol(0, m_txSymbolLen);
 
         sendStop();
 
         for (int i = 0; i < m_bits + 1; i++)
-            sendSymbol(1, m_symbolLen);
+            sendSymbol(1, m_txSymbolLen);
 
         sendStop();
         sendIdle();
@@ -433,92 +644,65 @@ void ModemRTTY::iShutdown()
 
 void ModemRTTY::resetFilters()
 {
-    int filterLength = 1024; // UNDONE: determine filter length by 2 * block size?
-
-    if (m_markFilter) {
-        m_markFilter->rttyFilter(m_baud / getSampleRate());
-    }
-    else {
-        m_markFilter = new FFTFilter(m_baud / getSampleRate(), filterLength);
-        m_markFilter->rttyFilter(m_baud / getSampleRate());
-    }
-
-    if (m_spaceFilter) {
-        m_spaceFilter->rttyFilter(m_baud / getSampleRate());
-    }
-    else {
-        m_spaceFilter = new FFTFilter(m_baud / getSampleRate(), filterLength);
-        m_spaceFilter->rttyFilter(m_baud / getSampleRate());
-    }
-}
-
-std::complex<double> ModemRTTY::mix(double& phase, double frq, std::complex<double> in)
-{
-    std::complex<double> z = std::complex<double>(cos(phase), sin(phase)) * in;
-
-    phase -= TWO_PI * frq / getSampleRate();
-    if (phase < -TWO_PI)
-        phase += TWO_PI;
-
-    return z;
+    // the sample rate may have changed, the plans are shared, so this is cheap
+    delete m_filter;
+    m_filter = new FFTFilterBank(getSampleRate(), FILTER_LENGTH);
+    m_filter->rttyFilter(m_baud);
+    m_filter->setChannels(2);
+
+    // partitioned convolution is opt-in, it costs more CPU than overlap-add
+    int blockSize = FILTER_LENGTH / 2;
+    if (m_blockSize > 0)
+        blockSize = qMax(MIN_BLOCK_SIZE, m_blockSize);
+    m_filter->setBlockSize(blockSize);
+
+    // keep at least MIN_SYMBOL_SAMPLES per symbol, the filter bank rounds the factor
+    // down to a divisor of the block size
+    int decimation = m_decimation;
+    if (decimation <= 0)
+        decimation = qMax(1, m_txSymbolLen / MIN_SYMBOL_SAMPLES);
+    m_filter->setDecimation(decimation);
 }
 
-bool ModemRTTY::rx(bool bit)
+bool ModemRTTY::rx(BitSync& sync, bool bit)
 {
     bool flag = false;
     int correction;
 
-    for (int i = 1; i < m_symbolLen; i++)
-        m_bitBuf[i-1] = m_bitBuf[i];
-    m_bitBuf[m_symbolLen - 1] = bit;
+    sync.bits.push(bit);
 
-    switch (m_rxState) {
+    switch (sync.state) {
     case RXSTATE_IDLE:
-        if (isMarkSpace(correction)) {
-            m_rxState = RXSTATE_START;
-            m_counter = correction;
+        if (isMarkSpace(sync.bits, correction)) {
+            sync.state = RXSTATE_START;
+            sync.counter = correction;
         }
         break;
     case RXSTATE_START:
-        if (--m_counter == 0) {
-            if (!isMark()) {
-                m_rxState = RXSTATE_DATA;
-                m_counter = m_symbolLen;
-                m_bitCounter = 0;
-                m_rxData = 0;
+        if (--sync.counter == 0) {
+            if (!isMark(sync.bits)) {
+                sync.state = RXSTATE_DATA;
+                sync.counter = m_symbolLen;
+                sync.bitCounter = 0;
+                sync.rxData = 0;
             } else {
-                m_rxState = RXSTATE_IDLE;
+                sync.state = RXSTATE_IDLE;
             }
         }
         break;
     case RXSTATE_DATA:
-        if (--m_counter == 0) {
-            m_rxData |= isMark() << m_bitCounter++;
-            m_counter = m_symbolLen;
+        if (--sync.counter == 0) {
+            sync.rxData |= isMark(sync.bits) << sync.bitCounter++;
+            sync.counter = m_symbolLen;
         }
-        if (m_bitCounter == m_bits + (m_parity != PARITY_NONE ? 1 : 0))
-            m_rxState = RXSTATE_STOP;
+        if (sync.bitCounter == m_bits + (m_parity != PARITY_NONE ? 1 : 0))
+            sync.state = RXSTATE_STOP;
         break;
     case RXSTATE_STOP:
-        if (--m_counter == 0) {
-            if (isMark()) {
-                //if ((metric >= progStatus.sldrSquelchValue && progStatus.sqlonoff) || !progStatus.sqlonoff) {
-                if (isSquelchOpen()) {
-                    char c = decode();
-                    if (c != 0) {
-                        // supress <CR><CR> and <LF><LF> sequences
-                        // these were observed during the RTTY contest 2/9/2013
-                        if (c == '\r' && m_lastChar == '\r');
-                        else if (c == '\n' && m_lastChar == '\n');
-                        else {
-                            emit received((char)c);
-                        }
-                        m_lastChar = c;
-                    }
-                    flag = true;
-                }
-            }
-            m_rxState = RXSTATE_IDLE;
+        if (--sync.counter == 0) {
+            // a complete frame has been received if the stop bit is valid
+            flag = isMark(sync.bits);
+            sync.state = RXSTATE_IDLE;
         }
         break;
     default:
@@ -528,6 +712,59 @@ bool ModemRTTY::rx(bool bit)
     return flag;
 }
 
+/**
+ * @brief Decodes a received frame and emits the character
+ */
+void ModemRTTY::receive(int rxData)
+{
+    char c = decode(rxData);
+    if (c != 0) {
+        // supress <CR><CR> and <LF><LF> sequences
+        // these were observed during the RTTY contest 2/9/2013
+        if (c == '\r' && m_lastChar == '\r');
+        else if (c == '\n' && m_lastChar == '\n');
+        else {
+            emit received((char)c);
+        }
+        m_lastChar = c;
+    }
+}
+
+/**
+ * @brief Returns the frame received by most demodulators in diversity mode, or -1 if less than
+ * half of the demodulators agree. The vote is cleared afterwards.
+ */
+int ModemRTTY::vote()
+{
+    int best = -1;
+    int bestVotes = 0;
+
+    for (int i = 0; i < NUM_ATC; i++) {
+        const int rxData = m_votes[VOTE_ORDER[i]];
+        if (rxData < 0)
+            continue;
+
+        int votes = 0;
+        for (int k = 0; k < NUM_ATC; k++)
+            votes += m_votes[k] == rxData;
+
+        // ties go to the demodulator that comes first in VOTE_ORDER
+        if (votes > bestVotes) {
+            best = rxData;
+            bestVotes = votes;
+        }
+    }
+
+    for (int i = 0; i < NUM_ATC; i++)
+        m_votes[i] = -1;
+
+    // a single demodulator triggering on noise does not produce a character
+    if (bestVotes < NUM_ATC / 2)
+        return -1;
+
+    return best;
+}
+
 int ModemRTTY::rParity(int c)
 {
     int w = c;
@@ -558,36 +795,35 @@ int ModemRTTY::rttyParity(unsigned int c)
     }
 }
 
-bool ModemRTTY::isMark()
+bool ModemRTTY::isMark(const BitHistory& bits) const
 {
-    return m_bitBuf[m_symbolLen / 2];
+    return bits.at(m_symbolLen / 2);
 }
 
-bool ModemRTTY::isMarkSpace(int& correction)
+bool ModemRTTY::isMarkSpace(const BitHistory& bits, int& correction) const
 {
     correction = 0;
     // test for rough bit position
-    if (m_bitBuf.front() && !m_bitBuf.back()) {
+    if (bits.oldest() && !bits.newest()) {
         // test for mark/space straddle point
-        for (int i = 0; i < m_symbolLen; i++)
-            correction += m_bitBuf[i];
-        if (abs(m_symbolLen / 2 - correction) < 6) // too small & bad signals are not decoded
+        correction = bits.ones();
+        if (abs(m_symbolLen / 2 - correction) < m_syncTolerance) // too small & bad signals are not decoded
             return true;
     }
     return false;
 }
 
-char ModemRTTY::decode()
+char ModemRTTY::decode(int rxData)
 {
     unsigned int parbit, par, data;
 
-    parbit = (m_rxData >> m_bits) & 1;
-    par = rttyParity(m_rxData);
+    parbit = (rxData >> m_bits) & 1;
+    par = rttyParity(rxData);
 
     if (m_parity != PARITY_NONE && parbit != par)
         return 0;
 
-    data = m_rxData & ((1 << m_bits) - 1);
+    data = rxData & ((1 << m_bits) - 1);
 
     if (m_bits == 5)
         return baudotDec(data);
@@ -648,41 +884,57 @@ char ModemRTTY::baudotDec(unsigned char data)
     return out;
 }
 
-double ModemRTTY::computeMetric() const
+/**
+ * @brief Compares the power at the mark and space tones with the power of a band of the same
+ * width between them, read from the band power index of the input spectrum. The averages
+ * advance once per spectrum frame, blocks without a new frame keep the last metric.
+ */
+double ModemRTTY::computeMetric()
 {
-    /*double delta = rtty_baud/8.0;
-    double np = wf->powerDensity(frequency, delta) * 3000 / delta;
-    double sp =
-        wf->powerDensity(frequency - shift/2, delta) +
-        wf->powerDensity(frequency + shift/2, delta) + 1e-10;
-    double snr = 0;
-
-    sigpwr = decayavg( sigpwr, sp, sp > sigpwr ? 2 : 8);
-    noisepwr = decayavg( noisepwr, np, 16 );
-    snr = 10*log10(sigpwr / noisepwr);
+    const BandPower* bandPower = getBandPower();
+    if (!bandPower)
+        return 0;
 
-    snprintf(snrmsg, sizeof(snrmsg), "s/n %-3.0f dB", snr);
-    put_Status2(snrmsg);
-    metric = CLAMP((3000 / delta) * (sigpwr/noisepwr), 0.0, 100.0);
-    display_metric(metric);*/
-    return 0;
+    const qint64 frame = bandPower->getFrame();
+    if (frame < 0 || frame == m_metricFrame)
+        return m_lastMetric;
+    m_metricFrame = frame;
+
+    const double delta = m_baud / 8.0;
+    const double frequency = getFrequency();
+    const double np = bandPower->powerDensity(frequency, delta) * 3000 / delta;
+    const double sp =
+            bandPower->powerDensity(frequency - m_shift / 2, delta) +
+            bandPower->powerDensity(frequency + m_shift / 2, delta) + 1e-10;
+
+    m_sigPwr = decayAvg(m_sigPwr, sp, sp > m_sigPwr ? 2 : 8);
+    m_noisePwr = decayAvg(m_noisePwr, np, 16);
+    if (m_noisePwr <= 0)
+        return m_lastMetric = 0;
+
+    m_lastMetric = clamp((3000 / delta) * (m_sigPwr / m_noisePwr), 0.0, 100.0);
+    return m_lastMetric;
 }
 
 void ModemRTTY::sendSymbol(int symbol, int len)
 {
     //acc_symbols += len;
 
-    double const freq1 = getFrequency() + m_shift / 2.0;
-    double const freq2 = getFrequency() - m_shift / 2.0;
+    m_oscMark.setFrequency(getFrequency() + m_shift / 2.0);
+    m_oscSpace.setFrequency(getFrequency() - m_shift / 2.0);
     double mark = 0, space = 0;
 
     if (isReverse())
         symbol = !symbol;
 
+    if (m_outBuf.size() < len)
+        m_outBuf.resize(len);
+    double* outBuf = m_outBuf.data();
+
     for(int i = 0; i < len; ++i) {
-        mark  = m_symShaperMark->update(symbol) * m_oscMark->update(freq1);
-        space = m_symShaperSpace->update(!symbol) * m_oscSpace->update(freq2);
-        writeSample(mark + space);
+        mark  = m_symShaperMark->update(symbol) * m_oscMark.nextSin();
+        space = m_symShaperSpace->update(!symbol) * m_oscSpace.nextSin();
+        outBuf[i] = mark + space;
 
         /*if (minamp > outbuf[i])
             minamp = outbuf[i];
@@ -690,7 +942,7 @@ void ModemRTTY::sendSymbol(int symbol, int len)
             maxamp = outbuf[i];*/
     }
 
-    //ModulateXmtr(outbuf, symbollen);
+    writeSamples(outBuf, len);
 }
 
 void ModemRTTY::sendChar(int c)
@@ -703,14 +955,14 @@ void ModemRTTY::sendChar(int c)
     }
 
     // start bit
-    sendSymbol(0, m_symbolLen);
+    sendSymbol(0, m_txSymbolLen);
     // data bits
     for (int i = 0; i < m_bits; i++) {
-        sendSymbol((c >> i) & 1, m_symbolLen);
+        sendSymbol((c >> i) & 1, m_txSymbolLen);
     }
     // parity bit
     if (m_parity != PARITY_NONE)
-        sendSymbol(rttyParity(c), m_symbolLen);
+        sendSymbol(rttyParity(c), m_txSymbolLen);
     // stop bit(s)
     sendStop();
 
@@ -735,8 +987,8 @@ void ModemRTTY::sendStop()
 {
     //acc_symbols += len;
 
-    double const freq1 = getFrequency() + m_shift / 2.0;
-    double const freq2 = getFrequency() - m_shift / 2.0;
+    m_oscMark.setFrequency(getFrequency() + m_shift / 2.0);
+    m_oscSpace.setFrequency(getFrequency() - m_shift / 2.0);
     double mark = 0, space = 0;
 
     bool symbol = true;
@@ -744,13 +996,17 @@ void ModemRTTY::sendStop()
     if (isReverse())
         symbol = !symbol;
 
+    if (m_outBuf.size() < m_stopLen)
+        m_outBuf.resize(m_stopLen);
+    double* outBuf = m_outBuf.data();
+
     for (int i = 0; i < m_stopLen; ++i) {
-        mark  = m_symShaperMark->update(symbol) * m_oscMark->update(freq1);
-        space = m_symShaperSpace->update(!symbol) * m_oscSpace->update(freq2);
-        writeSample(mark + space);
+        mark  = m_symShaperMark->update(symbol) * m_oscMark.nextSin();
+        space = m_symShaperSpace->update(!symbol) * m_oscSpace.nextSin();
+        outBuf[i] = mark + space;
     }
 
-    //ModulateXmtr(outbuf, symbollen);
+    writeSamples(outBuf, m_stopLen);
 }
 
 void ModemRTTY::sendIdle()
@@ -765,32 +1021,63 @@ void ModemRTTY::sendIdle()
 
 void ModemRTTY::flushStream()
 {
-    double const freq1 = getFrequency() + m_shift / 2.0;
-    double const freq2 = getFrequency() - m_shift / 2.0;
+    m_oscMark.setFrequency(getFrequency() + m_shift / 2.0);
+    m_oscSpace.setFrequency(getFrequency() - m_shift / 2.0);
     double mark = 0, space = 0;
 
-    for (int i = 0; i < m_symbolLen * 6; ++i) {
-        mark  = m_symShaperMark->update(0) * m_oscMark->update(freq1);
-        space = m_symShaperSpace->update(0) * m_oscSpace->update(freq2);
-        writeSample(mark + space);
+    const int len = m_txSymbolLen * 6;
+    if (m_outBuf.size() < len)
+        m_outBuf.resize(len);
+    double* outBuf = m_outBuf.data();
+
+    for (int i = 0; i < len; ++i) {
+        mark  = m_symShaperMark->update(0) * m_oscMark.nextSin();
+        space = m_symShaperSpace->update(0) * m_oscSpace.nextSin();
+        outBuf[i] = mark + space;
     }
 
-    //ModulateXmtr(outbuf, symbollen * 6);
+    writeSamples(outBuf, len);
+}
+
+ModemRTTY::BitSync::BitSync()
+    : state(RXSTATE_IDLE),
+      counter(0),
+      bitCounter(0),
+      rxData(0)
+{
+}
+
+void ModemRTTY::BitSync::reset(int symbolLen)
+{
+    bits.resize(symbolLen);
+    state = RXSTATE_IDLE;
+    counter = 0;
+    bitCounter = 0;
+    rxData = 0;
+}
+
+BitHistory::BitHistory()
+    : m_size(0),
+      m_oldest(0),
+      m_ones(0)
+{
 }
 
-Oscillator::Oscillator(double samplerate)
+/**
+ * @brief Sets the number of bits kept in the history and clears it
+ */
+void BitHistory::resize(int size)
 {
-    m_phase = 0;
-    m_samplerate = samplerate;
-    //std::cerr << "samplerate for Oscillator:"<<m_samplerate<<"\n";
+    m_size = size > 0 ? size : 1;
+    m_bits.resize(m_size);
+    clear();
 }
 
-double Oscillator::update(double frequency)
+void BitHistory::clear()
 {
-    m_phase += (frequency / m_samplerate) * TWO_PI;
-    if (m_phase > M_PI)
-        m_phase -= TWO_PI;
-    return (sin(m_phase));
+    m_bits.assign(m_bits.size(), 0);
+    m_oldest = 0;
+    m_ones = 0;
 }
 
 SymbolShaper::SymbolShaper(double baud, double sr)
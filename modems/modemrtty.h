@@ -28,16 +28,68 @@
 #define MODEMRTTY_H
 
 #include "modem.h"
-#include "../signalprocessing/fftfilter.h"
+#include "../signalprocessing/fftfilterbank.h"
 #include "../signalprocessing/filters.h"
+#include "../signalprocessing/nco.h"
+#include <QAtomicInt>
 #include <complex>
+#include <vector>
 
 namespace Digital {
 namespace Internal {
 
-class Oscillator;
 class SymbolShaper;
 
+/**
+ * @brief Circular history of the last demodulated bits of one symbol length. Pushing a bit,
+ * indexed access and the number of set bits are all constant time.
+ */
+class BitHistory
+{
+public:
+    BitHistory();
+
+    void resize(int size);
+    void clear();
+
+    /// Appends the newest bit and drops the oldest one.
+    inline void push(bool bit) {
+        m_ones += (int)bit - (int)m_bits[m_oldest];
+        m_bits[m_oldest] = bit;
+        if (++m_oldest == m_size)
+            m_oldest = 0;
+    }
+
+    /// Returns the bit at index i, counted from the oldest bit.
+    inline bool at(int i) const {
+        i += m_oldest;
+        return m_bits[i >= m_size ? i - m_size : i];
+    }
+
+    inline bool oldest() const {
+        return m_bits[m_oldest];
+    }
+
+    inline bool newest() const {
+        return m_bits[m_oldest == 0 ? m_size - 1 : m_oldest - 1];
+    }
+
+    /// Returns the number of set bits in the history.
+    inline int ones() const {
+        return m_ones;
+    }
+
+    inline int size() const {
+        return m_size;
+    }
+
+private:
+    std::vector<unsigned char>  m_bits;
+    int                         m_size;
+    int                         m_oldest;
+    int                         m_ones;
+};
+
 class ModemRTTY
         : public Modem
 {
@@ -65,6 +117,7 @@ public:
         DEMOD_KAHN_LINEAR_ATC,
         DEMOD_KAHN_CLIPPED_ATC,
         DEMOD_NO_ATC,
+        DEMOD_DIVERSITY     // all of the above, voting per character
     };
 
     ModemRTTY(QObject*);
@@ -80,6 +133,8 @@ public:
     void setStopBits(StopBits);
     void setDemodulator(Demodulator);
     void setUnshiftOnSpace(bool);
+    void setDecimation(int);
+    void setBlockSize(int);
 
 protected:
     bool iInit();
@@ -87,18 +142,40 @@ protected:
     void iShutdown();
     void iRxProcess(const QVector<double>&);
     void iTxProcess();
-    double computeMetric() const;
+    double computeMetric();
     double getBandwidth() const;
 
 private:
     void    resetFilters();
-    std::complex<double> mix(double& phase, double frq, std::complex<double> in);
-    bool    rx(bool bit);
+    enum RxState {
+        RXSTATE_IDLE = 0,
+        RXSTATE_START,
+        RXSTATE_DATA,
+        RXSTATE_STOP
+    };
+
+    /// Bit synchronizer state, there is one for each demodulator in diversity mode.
+    struct BitSync {
+        BitSync();
+        void reset(int symbolLen);
+
+        BitHistory  bits;
+        RxState     state;
+        int         counter;
+        int         bitCounter;
+        int         rxData;
+    };
+
+    void    demodulate(const std::complex<double>* mark, const std::complex<double>* space, int count);
+    void    trackFrequency(const std::complex<double>& mark, const std::complex<double>& space, bool reverse);
+    bool    rx(BitSync& sync, bool bit);
+    void    receive(int rxData);
+    int     vote();
     int     rParity(int);
     int     rttyParity(unsigned int);
-    bool    isMark();
-    bool    isMarkSpace(int&);
-    char    decode();
+    bool    isMark(const BitHistory& bits) const;
+    bool    isMarkSpace(const BitHistory& bits, int&) const;
+    char    decode(int rxData);
     int     baudotEnc(unsigned char data);
     char    baudotDec(unsigned char data);
     void    metric();
@@ -117,43 +194,68 @@ private:
     static const int    BITS[];
 
     // general parameters
-    int         m_symbolLen;
+    int         m_symbolLen;        // samples per symbol at the decimated receive rate
+    int         m_txSymbolLen;      // samples per symbol at the audio sample rate
     double      m_shift;
     int         m_bits;
     double      m_baud;
     int         m_stopLen;
     Parity      m_parity;
     StopBits    m_stopBits;
-    Demodulator m_demodulator;
+    QAtomicInt  m_demodulator;      // read once per block by the receiver
     bool        m_unshiftOnSpace;
+    int         m_decimation;       // 0 selects the factor from the baud rate
+    int         m_blockSize;        // 0 selects the filter block size from the baud rate
+
+    // mark and space filter bank
+    static const int FILTER_LENGTH;
+    static const int MIN_BLOCK_SIZE;
+    enum Channel {
+        CHANNEL_MARK = 0,
+        CHANNEL_SPACE
+    };
+    FFTFilterBank*  m_filter;
+
+    // decimation of the filtered channels
+    static const int MIN_SYMBOL_SAMPLES;
+    int         m_rxDecimation;
+    double      m_rxSampleRate;
+    int         m_syncTolerance;
 
     // mark processing
-    double      m_markPhase;
     double		m_markNoise;
-    FFTFilter*  m_markFilter;
     double      m_markEnv;
 
     // space processing
-    double      m_spacePhase;
     double		m_spaceNoise;
-    FFTFilter*  m_spaceFilter;
     double      m_spaceEnv;
 
+    // signal and noise power from the spectrum of the input
+    double      m_sigPwr;
+    double      m_noisePwr;
+    qint64      m_metricFrame;      // spectrum frame of the last metric update
+    double      m_lastMetric;
+
     std::complex<double> m_prevMark;
     std::complex<double> m_prevSpace;
 
-    std::vector<bool> m_bitBuf;
-
-    enum RxState {
-        RXSTATE_IDLE = 0,
-        RXSTATE_START,
-        RXSTATE_DATA,
-        RXSTATE_STOP
-    } m_rxState;
-
-    int m_counter;
-    int m_bitCounter;
-    int m_rxData;
+    // bit synchronizers, only the first one is used unless in diversity mode
+    static const int NUM_ATC = DEMOD_DIVERSITY;
+    static const Demodulator VOTE_ORDER[NUM_ATC];
+    BitSync     m_syncs[NUM_ATC];
+    int         m_votes[NUM_ATC];   // frame received by each demodulator, -1 if none
+    int         m_voteCountdown;    // samples until the open vote is decided, 0 if none is open
+    int         m_activeDemodulator;
+
+    // block buffers of the receive chain
+    QVector<std::complex<double> > m_rxMarkOut;
+    QVector<std::complex<double> > m_rxSpaceOut;
+    QVector<double> m_rxMarkMag;
+    QVector<double> m_rxSpaceMag;
+    QVector<double> m_rxMarkEnv;
+    QVector<double> m_rxSpaceEnv;
+    QVector<double> m_rxNoiseFloor;
+    QVector<double> m_rxValue;
 
     char m_lastChar;
 
@@ -162,28 +264,15 @@ private:
         MODE_FIGURES = 0x200
     } m_rxMode, m_txMode;
 
-    Oscillator*     m_oscMark;
-    Oscillator*     m_oscSpace;
+    NCO             m_oscMark;
+    NCO             m_oscSpace;
     SymbolShaper*   m_symShaperMark;
     SymbolShaper*   m_symShaperSpace;
+    QVector<double> m_outBuf;   // a symbol is rendered into this buffer and written at once
 
     bool            m_stopFlag;
 };
 
-// simple oscillator-class
-class Oscillator
-{
-public:
-    Oscillator(double samplerate);
-    ~Oscillator() {}
-
-    double update(double frequency);
-
-private:
-    double m_phase;
-    double m_samplerate;
-};
-
 class SymbolShaper
 {
 public:
@@ -17,3 +17,8 @@ void ModemTransmitter::writeValue(double value)
 {
     write(value);
 }
+
+void ModemTransmitter::writeValues(const double* values, qint64 count)
+{
+    write(values, count);
+}
@@ -22,6 +22,7 @@ public:
     ~ModemTransmitter();
 
     void writeValue(double value);
+    void writeValues(const double* values, qint64 count);
 };
 
 } // Internal
@@ -0,0 +1,110 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "bandpower.h"
+
+using namespace Digital::Internal;
+
+BandPower::BandPower()
+    : m_firstFrq(0),
+      m_binSize(0),
+      m_frame(-1)
+{
+}
+
+/**
+ * @brief Replaces the spectrum by bins power values. firstFrq is the center frequency of the
+ * first bin and frame the number of the spectrum frame they belong to.
+ */
+void BandPower::update(const double* power, int bins, double firstFrq, double binSize,
+                       qint64 frame)
+{
+    // only the writer touches the next sums, the lock is held for the swap only
+    m_nextSums.resize(bins + 1);
+    double sum = 0;
+    m_nextSums[0] = 0;
+    for (int i = 0; i < bins; i++) {
+        sum += power[i];
+        m_nextSums[i + 1] = sum;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    m_sums.swap(m_nextSums);
+    m_firstFrq = firstFrq;
+    m_binSize = binSize;
+    m_frame = frame;
+}
+
+void BandPower::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_sums.clear();
+    m_frame = -1;
+}
+
+bool BandPower::isValid() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frame >= 0;
+}
+
+/**
+ * @brief Returns the number of the spectrum frame the queries refer to, -1 if there is none
+ */
+qint64 BandPower::getFrame() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frame;
+}
+
+/**
+ * @brief Returns the power in the band of the given bandwidth centered at frq. The parts of
+ * the band outside the spectrum contribute nothing.
+ */
+double BandPower::powerDensity(double frq, double bandwidth) const
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_sums.size() < 2 || m_binSize <= 0)
+        return 0;
+
+    return sumBelow(frq + bandwidth / 2.0) - sumBelow(frq - bandwidth / 2.0);
+}
+
+/**
+ * @brief Returns the power below frq, assuming the power of a bin is spread evenly over the
+ * bin width. Must be called with the lock held.
+ */
+double BandPower::sumBelow(double frq) const
+{
+    const int bins = m_sums.size() - 1;
+    const double pos = (frq - m_firstFrq) / m_binSize + 0.5;
+    if (pos <= 0)
+        return 0;
+    if (pos >= bins)
+        return m_sums[bins];
+
+    const int bin = (int)pos;
+    return m_sums[bin] + (pos - bin) * (m_sums[bin + 1] - m_sums[bin]);
+}
@@ -0,0 +1,69 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef BANDPOWER_H
+#define BANDPOWER_H
+
+#include <QMutex>
+#include <QVector>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The BandPower class answers queries for the power in a frequency band of the latest
+ * spectrum in constant time. It keeps the running sums of the bin powers, the power between
+ * two frequencies is the difference of the sums at both frequencies, interpolated within the
+ * bins. Bands narrower than a bin therefore get their share of the bin power.
+ *
+ * The spectrum worker updates it once per frame, any number of threads may query it.
+ */
+class BandPower
+{
+public:
+    BandPower();
+
+    void update(const double* power, int bins, double firstFrq, double binSize, qint64 frame);
+    void clear();
+
+    bool isValid() const;
+    qint64 getFrame() const;
+    double powerDensity(double frq, double bandwidth) const;
+
+private:
+    double sumBelow(double frq) const;
+
+    mutable QMutex  m_mutex;
+    QVector<double> m_sums;     // m_sums[i] is the power of the bins below bin i
+    QVector<double> m_nextSums; // filled by the writer outside the lock, then swapped
+    double          m_firstFrq; // center frequency of the first bin
+    double          m_binSize;
+    qint64          m_frame;    // -1 if there is no spectrum yet
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // BANDPOWER_H
@@ -0,0 +1,280 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "builtinfftbackend.h"
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <QtGlobal>
+
+namespace Digital {
+namespace Internal {
+
+typedef std::complex<double> Complex;
+
+// std::complex multiplication checks for infinities and is not inlined by most compilers
+static inline Complex mul(const Complex& a, const Complex& b)
+{
+    return Complex(a.real() * b.real() - a.imag() * b.imag(),
+                   a.real() * b.imag() + a.imag() * b.real());
+}
+
+static inline Complex mulConj(const Complex& a, const Complex& b)
+{
+    return Complex(a.real() * b.real() + a.imag() * b.imag(),
+                   a.imag() * b.real() - a.real() * b.imag());
+}
+
+// multiplication by j for the inverse and by -j for the forward transform
+template <bool Inverse>
+static inline Complex rotate(const Complex& a)
+{
+    return Inverse ? Complex(-a.imag(), a.real()) : Complex(a.imag(), -a.real());
+}
+
+/**
+ * @brief Split-radix decimation in time. Transforms n values of the input, taken with the
+ * given stride, into n consecutive values of the output. The twiddle factor W_n^k is found
+ * at tw[k * twStride].
+ */
+template <bool Inverse>
+static void splitRadix(const Complex* in, Complex* out, int n, int stride,
+                       const Complex* tw, int twStride)
+{
+    if (n == 1) {
+        out[0] = in[0];
+        return;
+    }
+    if (n == 2) {
+        out[0] = in[0] + in[stride];
+        out[1] = in[0] - in[stride];
+        return;
+    }
+    if (n == 4) {
+        const Complex t0 = in[0] + in[2 * stride];
+        const Complex t1 = in[0] - in[2 * stride];
+        const Complex t2 = in[stride] + in[3 * stride];
+        const Complex t3 = rotate<Inverse>(in[stride] - in[3 * stride]);
+        out[0] = t0 + t2;
+        out[1] = t1 + t3;
+        out[2] = t0 - t2;
+        out[3] = t1 - t3;
+        return;
+    }
+
+    // even samples into the first half, samples 4k+1 and 4k+3 into the quarters behind
+    const int n2 = n / 2;
+    const int n4 = n / 4;
+    splitRadix<Inverse>(in, out, n2, 2 * stride, tw, 2 * twStride);
+    splitRadix<Inverse>(in + stride, out + n2, n4, 4 * stride, tw, 4 * twStride);
+    splitRadix<Inverse>(in + 3 * stride, out + n2 + n4, n4, 4 * stride, tw, 4 * twStride);
+
+    for (int k = 0; k < n4; k++) {
+        const Complex& w1 = tw[k * twStride];
+        const Complex& w3 = tw[3 * k * twStride];
+        const Complex a = Inverse ? mulConj(out[n2 + k], w1) : mul(out[n2 + k], w1);
+        const Complex b = Inverse ? mulConj(out[n2 + n4 + k], w3) : mul(out[n2 + n4 + k], w3);
+        const Complex sum = a + b;
+        const Complex diff = rotate<Inverse>(a - b);
+        const Complex u0 = out[k];
+        const Complex u1 = out[n4 + k];
+        out[k] = u0 + sum;
+        out[n2 + k] = u0 - sum;
+        out[n4 + k] = u1 + diff;
+        out[n2 + n4 + k] = u1 - diff;
+    }
+}
+
+class BuiltinFFT
+        : public FFT
+{
+public:
+    BuiltinFFT(Type type, int size)
+        : FFT(type, size),
+          m_twiddles(size)
+    {
+        // W_N^k = exp(-2 pi j k / N), real transforms use every second one for the
+        // complex transform of half the size and all of them to separate the spectra
+        for (int k = 0; k < size; k++)
+            m_twiddles[k] = std::polar(1.0, -2.0 * M_PI * k / size);
+    }
+
+    void execute(const FFTComplex* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() != TYPE_REAL);
+        const Complex* x = reinterpret_cast<const Complex*>(in);
+        Complex* y = reinterpret_cast<Complex*>(out);
+        if (getType() == TYPE_BACKWARD)
+            splitRadix<true>(x, y, getSize(), 1, m_twiddles.data(), 1);
+        else
+            splitRadix<false>(x, y, getSize(), 1, m_twiddles.data(), 1);
+    }
+
+    void execute(const double* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() == TYPE_REAL);
+
+        // the even samples are the real and the odd samples the imaginary part of a complex
+        // sequence of half the size
+        const int half = getSize() / 2;
+        const Complex* tw = m_twiddles.data();
+        Complex* y = reinterpret_cast<Complex*>(out);
+        splitRadix<false>(reinterpret_cast<const Complex*>(in), y, half, 1, tw, 2);
+
+        // separate the spectra of the even and odd samples and combine them, bins k and
+        // half-k are computed together as both need Z[k] and Z[half-k]
+        const Complex z0 = y[0];
+        y[0] = Complex(z0.real() + z0.imag(), 0);
+        y[half] = Complex(z0.real() - z0.imag(), 0);
+        for (int k = 1; k <= half / 2; k++) {
+            const Complex zk = y[k];
+            const Complex zm = y[half - k];
+            y[k] = combine(zk, zm, tw[k]);
+            if (k != half - k)
+                y[half - k] = combine(zm, zk, tw[half - k]);
+        }
+    }
+
+private:
+    // X[k] = (Z[k] + Z*[N/2-k]) / 2 - j W_N^k (Z[k] - Z*[N/2-k]) / 2
+    static inline Complex combine(const Complex& zk, const Complex& zm, const Complex& w)
+    {
+        const Complex even = 0.5 * (zk + std::conj(zm));
+        const Complex odd = rotate<false>(0.5 * (zk - std::conj(zm)));
+        return even + mul(w, odd);
+    }
+
+    std::vector<Complex> m_twiddles;
+};
+
+/**
+ * @brief Transform of any size by Bluestein's algorithm. With nk = (k^2 + n^2 - (k-n)^2) / 2
+ * the DFT becomes a convolution of x[n] * W^(n^2/2) with the chirp W^(-n^2/2), computed by
+ * power of two transforms of at least 2N-1 values. This is a few times slower than a power
+ * of two transform of similar size, the buffers are allocated per call as plans are shared.
+ */
+class BluesteinFFT
+        : public FFT
+{
+public:
+    BluesteinFFT(Type type, int size)
+        : FFT(type, size),
+          m_size(1),
+          m_chirp(size)
+    {
+        while (m_size < 2 * size - 1)
+            m_size *= 2;
+
+        m_twiddles.resize(m_size);
+        for (int k = 0; k < m_size; k++)
+            m_twiddles[k] = std::polar(1.0, -2.0 * M_PI * k / m_size);
+
+        // k^2 is taken modulo 2N, the chirp is periodic and the phase stays exact
+        const double sign = type == TYPE_BACKWARD ? 1.0 : -1.0;
+        for (int k = 0; k < size; k++) {
+            const qint64 k2 = ((qint64)k * k) % (2 * size);
+            m_chirp[k] = std::polar(1.0, sign * M_PI * k2 / size);
+        }
+
+        // spectrum of the conjugate chirp, placed at negative indices for k < 0
+        std::vector<Complex> b(m_size, Complex(0, 0));
+        for (int k = 0; k < size; k++) {
+            b[k] = std::conj(m_chirp[k]);
+            if (k > 0)
+                b[m_size - k] = b[k];
+        }
+        m_chirpSpectrum.resize(m_size);
+        splitRadix<false>(b.data(), m_chirpSpectrum.data(), m_size, 1, m_twiddles.data(), 1);
+
+        // includes the normalization of the inverse transform
+        for (int k = 0; k < m_size; k++)
+            m_chirpSpectrum[k] /= m_size;
+    }
+
+    void execute(const FFTComplex* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() != TYPE_REAL);
+        transform(reinterpret_cast<const Complex*>(in), reinterpret_cast<Complex*>(out),
+                  getSize());
+    }
+
+    void execute(const double* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() == TYPE_REAL);
+        std::vector<Complex> x(in, in + getSize());
+        transform(x.data(), reinterpret_cast<Complex*>(out), getSize() / 2 + 1);
+    }
+
+private:
+    // writes the first bins of the transform of x
+    void transform(const Complex* x, Complex* y, int bins) const
+    {
+        std::vector<Complex> a(m_size, Complex(0, 0));
+        std::vector<Complex> spectrum(m_size);
+        for (int k = 0; k < getSize(); k++)
+            a[k] = mul(x[k], m_chirp[k]);
+
+        splitRadix<false>(a.data(), spectrum.data(), m_size, 1, m_twiddles.data(), 1);
+        for (int k = 0; k < m_size; k++)
+            spectrum[k] = mul(spectrum[k], m_chirpSpectrum[k]);
+        splitRadix<true>(spectrum.data(), a.data(), m_size, 1, m_twiddles.data(), 1);
+
+        for (int k = 0; k < bins; k++)
+            y[k] = mul(a[k], m_chirp[k]);
+    }
+
+    int m_size;     // size of the power of two transforms
+    std::vector<Complex> m_chirp;
+    std::vector<Complex> m_chirpSpectrum;
+    std::vector<Complex> m_twiddles;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+using namespace Digital::Internal;
+
+QString BuiltinFFTBackend::getNameStatic()
+{
+    return "builtin";
+}
+
+QString BuiltinFFTBackend::getName() const
+{
+    return getNameStatic();
+}
+
+/**
+ * @brief Creates a transform, there is nothing to plan. Sizes that are not a power of two use
+ * Bluestein's algorithm.
+ */
+FFT* BuiltinFFTBackend::createFFT(FFT::Type type, int size, Effort)
+{
+    if (size < 1)
+        return 0;
+    if (size < 2 || (size & (size - 1)) != 0)
+        return new BluesteinFFT(type, size);
+    return new BuiltinFFT(type, size);
+}
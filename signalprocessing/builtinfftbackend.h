@@ -0,0 +1,53 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef BUILTINFFTBACKEND_H
+#define BUILTINFFTBACKEND_H
+
+#include "fftbackend.h"
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief Self-contained FFT backend without external dependencies. Complex transforms use a
+ * recursive split-radix algorithm, real transforms of size N are computed by a complex
+ * transform of size N/2. Sizes that are not a power of two are computed by Bluestein's
+ * algorithm with power of two transforms.
+ */
+class BuiltinFFTBackend
+        : public FFTBackend
+{
+public:
+    static QString getNameStatic();
+    QString getName() const;
+
+    FFT* createFFT(FFT::Type type, int size, Effort effort);
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // BUILTINFFTBACKEND_H
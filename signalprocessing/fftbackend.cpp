@@ -0,0 +1,121 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "fftbackend.h"
+#include "builtinfftbackend.h"
+#ifdef HAVE_FFTW
+#include "fftwbackend.h"
+#endif
+#include <QtGlobal>
+
+using namespace Digital::Internal;
+
+// enough for every SIMD instruction set, FFTW only requires that all arrays passed to a
+// plan share the same alignment
+static const size_t FFT_ALIGNMENT = 64;
+
+FFT::FFT(Type type, int size)
+    : m_type(type),
+      m_size(size)
+{
+}
+
+FFT::~FFT()
+{
+}
+
+FFT::Type FFT::getType() const
+{
+    return m_type;
+}
+
+int FFT::getSize() const
+{
+    return m_size;
+}
+
+/**
+ * @brief Allocates an array suitable for all transforms of all backends
+ */
+void* FFT::allocate(size_t size)
+{
+    return qMallocAligned(size, FFT_ALIGNMENT);
+}
+
+void FFT::release(void* data)
+{
+    qFreeAligned(data);
+}
+
+FFTBackend::~FFTBackend()
+{
+}
+
+bool FFTBackend::isTunable() const
+{
+    return false;
+}
+
+bool FFTBackend::importWisdom(const QString&)
+{
+    return false;
+}
+
+bool FFTBackend::exportWisdom(const QString&)
+{
+    return false;
+}
+
+/**
+ * @brief Returns the names of all backends compiled into the application
+ */
+QStringList FFTBackend::getNames()
+{
+    QStringList names;
+#ifdef HAVE_FFTW
+    names << FFTWBackend::getNameStatic();
+#endif
+    names << BuiltinFFTBackend::getNameStatic();
+    return names;
+}
+
+QString FFTBackend::getDefaultName()
+{
+    return getNames().first();
+}
+
+/**
+ * @brief Creates the backend with the given name, returns 0 if it is not available
+ */
+FFTBackend* FFTBackend::create(const QString& name)
+{
+#ifdef HAVE_FFTW
+    if (name == FFTWBackend::getNameStatic())
+        return new FFTWBackend();
+#endif
+    if (name == BuiltinFFTBackend::getNameStatic())
+        return new BuiltinFFTBackend();
+    return 0;
+}
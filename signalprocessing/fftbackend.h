@@ -0,0 +1,108 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef FFTBACKEND_H
+#define FFTBACKEND_H
+
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+
+namespace Digital {
+namespace Internal {
+
+/// Interleaved real and imaginary part, binary compatible with fftw_complex and std::complex<double>.
+typedef double FFTComplex[2];
+
+/**
+ * @brief The FFT class is a planned transform of a fixed type and size. Transforms are
+ * unnormalized and out-of-place, the input is not modified. A transform may be executed by
+ * several threads at once on different arrays, as long as all arrays are allocated with
+ * allocate().
+ */
+class FFT
+{
+public:
+    enum Type {
+        TYPE_FORWARD = 0,   // complex to complex, forward
+        TYPE_BACKWARD,      // complex to complex, backward
+        TYPE_REAL           // real to complex, size/2+1 output bins
+    };
+
+    FFT(Type type, int size);
+    virtual ~FFT();
+
+    Type getType() const;
+    int getSize() const;
+
+    /// Complex transform, only for TYPE_FORWARD and TYPE_BACKWARD.
+    virtual void execute(const FFTComplex* in, FFTComplex* out) const = 0;
+
+    /// Real transform, only for TYPE_REAL.
+    virtual void execute(const double* in, FFTComplex* out) const = 0;
+
+    static void* allocate(size_t size);
+    static void release(void* data);
+
+private:
+    Type    m_type;
+    int     m_size;
+};
+
+/**
+ * @brief The FFTBackend class creates the transforms of one FFT implementation. Creating
+ * transforms is not thread-safe, the FFTPlanCache serializes all calls to a backend.
+ */
+class FFTBackend
+{
+public:
+    enum Effort {
+        EFFORT_ESTIMATE = 0,    // fast creation, used for transforms that are needed right away
+        EFFORT_MEASURE,
+        EFFORT_PATIENT
+    };
+
+    virtual ~FFTBackend();
+
+    virtual QString getName() const = 0;
+
+    /// Returns a new transform or 0 if the backend does not support the size.
+    virtual FFT* createFFT(FFT::Type type, int size, Effort effort) = 0;
+
+    /// Returns true if a higher effort creates faster transforms.
+    virtual bool isTunable() const;
+
+    virtual bool importWisdom(const QString& fileName);
+    virtual bool exportWisdom(const QString& fileName);
+
+    static QStringList getNames();
+    static QString getDefaultName();
+    static FFTBackend* create(const QString& name);
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // FFTBACKEND_H
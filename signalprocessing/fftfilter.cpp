@@ -33,6 +33,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <typeinfo>
+#include <algorithm>
 
 #include <stdio.h>
 #include <sys/types.h>
@@ -41,6 +42,16 @@
 
 #include "misc.h"
 #include "fftfilter.h"
+#include "fftplancache.h"
+
+using Digital::Internal::FFT;
+using Digital::Internal::FFTComplex;
+using Digital::Internal::FFTPlanCache;
+
+// a channel response is shifted again when the channel has moved further
+const double FFTFilter::MAX_RESPONSE_DRIFT = 1.0 / 64;
+// energy of the impulse response left out of the partitions, -40 dB
+const double FFTFilter::MAX_TAIL_ENERGY = 1e-4;
 
 //------------------------------------------------------------------------------
 // fft filter
@@ -68,17 +79,39 @@ FFTFilter::FFTFilter(double f, int len)
 
 FFTFilter::~FFTFilter()
 {
-    fftw_destroy_plan(m_fftPlanForward);
-    fftw_destroy_plan(m_fftPlanBackward);
-    fftw_free(m_fftIn);
-    fftw_free(m_fftOut);
-
-    delete[] m_filter;
-    delete[] m_timedata;
-    delete[] m_freqdata;
-    delete[] m_output;
-    delete[] m_ovlbuf;
+    FFT::release(m_realIn);
+    FFT::release(m_fftIn);
+    FFT::release(m_fftOut);
+    FFT::release(m_fftWork);
+    FFT::release(m_filter);
+    FFT::release(m_ovlbuf);
+    FFT::release(m_fdl);
+
     delete[] m_ht;
+    delete[] m_impulse;
+}
+
+//------------------------------------------------------------------------------
+// rtty filter response at bin offset from the center, the offset need not be a
+// whole number
+//------------------------------------------------------------------------------
+std::complex<double> FFTFilter::rttyResponse(double bin) const
+{
+    const double i = fabs(bin);
+    const double x = i / m_flen2;
+
+    // raised cosine response (changed for -1.0...+1.0 times Nyquist-f
+    // instead of books versions ranging from -1..+1 times samplerate)
+    if (i >= m_flen2 || x > 2.0 * m_rttyF)
+        return 0;
+    double dht = x <= 0 ? 1.0 : cos((M_PI * x) / (m_rttyF * 4.0));
+
+    dht *= dht; // cos^2
+
+    // amplitude equalized nyquist-channel response
+    dht /= sinc(2.0 * i * m_rttyF);
+
+    return std::polar(dht, bin * -0.5 * M_PI);
 }
 
 //------------------------------------------------------------------------------
@@ -90,28 +123,155 @@ void FFTFilter::initFilter()
 {
     m_flen2 = m_flen >> 1;
 
-    m_fftIn = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * m_flen);
-    m_fftOut = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * m_flen);
-    m_fftPlanForward = fftw_plan_dft_1d(m_flen, m_fftIn, m_fftOut, FFTW_FORWARD, FFTW_ESTIMATE);
-    m_fftPlanBackward = fftw_plan_dft_1d(m_flen, m_fftIn, m_fftOut, FFTW_BACKWARD, FFTW_ESTIMATE);
-
-    m_filter	= new std::complex<double>[m_flen];
-    m_timedata	= new std::complex<double>[m_flen];
-    m_freqdata	= new std::complex<double>[m_flen];
-    m_output	= new std::complex<double>[m_flen];
-    m_ovlbuf	= new std::complex<double>[m_flen2];
+    // Input samples are written directly into the first half of the aligned FFT input,
+    // the second half stays zero. The filter runs without intermediate copies:
+    //   m_fftIn --forward--> m_fftOut, multiplied in place with the filter response
+    //   m_fftOut --backward--> m_fftIn, overlap-add in place
+    // so the first half of m_fftIn holds the output until new input arrives.
+    m_fftIn = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_flen);
+    m_fftOut = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_flen);
+    m_fftWork = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_flen);
+    memset(m_fftIn, 0, m_flen * sizeof(FFTComplex));
+
+    // real input is collected directly in the input array of the r2c plan, the
+    // second half stays zero
+    m_realIn = (double*)FFT::allocate(sizeof(double) * m_flen);
+    memset(m_realIn, 0, m_flen * sizeof(double));
+
+    // the plans are shared with all filters of the same length
+    m_decimation = 1;
+    m_blockSize = m_flen2;
+    m_partitions = 0;
+    m_impulseFirst = 0;
+    m_impulsePartitions = 0;
+    m_fdlPos = 0;
+    m_fdl = 0;
+    m_htScale = 1.0;
+    m_rttyF = 0;
+    m_planGeneration = -1;
+    updatePlans();
+
+    m_filter	= (std::complex<double>*)FFT::allocate(sizeof(FFTComplex) * m_flen);
+    m_ovlbuf	= (std::complex<double>*)FFT::allocate(sizeof(FFTComplex) * m_flen2);
     m_ht		= new std::complex<double>[m_flen];
+    m_impulse	= new std::complex<double>[m_flen];
 
     memset(m_filter, 0, m_flen * sizeof(std::complex<double>));
-    memset(m_timedata, 0, m_flen * sizeof(std::complex<double>));
-    memset(m_freqdata, 0, m_flen * sizeof(std::complex<double>));
-    memset(m_output, 0, m_flen * sizeof(std::complex<double>));
     memset(m_ovlbuf, 0, m_flen2 * sizeof(std::complex<double>));
     memset(m_ht, 0, m_flen * sizeof(std::complex<double>));
+    memset(m_impulse, 0, m_flen * sizeof(std::complex<double>));
 
     m_inptr = 0;
 }
 
+//------------------------------------------------------------------------------
+// fetch the plans from the plan cache again if they have been replaced by
+// measured ones
+//------------------------------------------------------------------------------
+void FFTFilter::updatePlans()
+{
+    FFTPlanCache& cache = FFTPlanCache::instance();
+    const int generation = cache.getGeneration();
+    if (generation == m_planGeneration)
+        return;
+
+    m_planGeneration = generation;
+    m_fftPlanForward = cache.getPlan(FFT::TYPE_FORWARD, m_flen);
+    m_fftPlanBackward = cache.getPlan(FFT::TYPE_BACKWARD, m_flen);
+    m_fftPlanReal = cache.getPlan(FFT::TYPE_REAL, m_flen);
+
+    // frames of the partitioned mode hold the previous and the current block
+    const int frame = m_partitions ? 2 * m_blockSize : m_flen;
+    m_fftPlanDecimated = cache.getPlan(FFT::TYPE_BACKWARD, frame / m_decimation);
+    m_fftPlanBlock = m_partitions ? cache.getPlan(FFT::TYPE_FORWARD, frame) : 0;
+    m_fftPlanBlockReal = m_partitions ? cache.getPlan(FFT::TYPE_REAL, frame) : 0;
+}
+
+//------------------------------------------------------------------------------
+// find the smallest circular range of bins that contains all non-zero bins of
+// a filter response, the filter bank skips all other bins
+//------------------------------------------------------------------------------
+void FFTFilter::findSupport(const std::complex<double>* response, int& first, int& length) const
+{
+    int zeroStart = 0;
+    int zeroLength = 0;
+    int runStart = 0;
+    int runLength = 0;
+
+    for (int i = 0; i < 2 * m_flen && zeroLength < m_flen; i++) {
+        if (response[i % m_flen] == 0.0) {
+            if (runLength++ == 0)
+                runStart = i;
+            if (runLength > zeroLength) {
+                zeroStart = runStart;
+                zeroLength = runLength;
+            }
+        } else {
+            runLength = 0;
+        }
+    }
+
+    first = (zeroStart + zeroLength) % m_flen;
+    length = std::max(m_flen - zeroLength, 0);
+}
+
+//------------------------------------------------------------------------------
+// find the shortest circular range of taps that holds all but MAX_TAIL_ENERGY
+// of the energy of an impulse response. Among ranges of the same length the one
+// with the least energy at its ends is taken, so a response that needs all taps
+// is cut where it is smallest.
+//------------------------------------------------------------------------------
+void FFTFilter::findImpulseSupport(const std::complex<double>* impulse, int& first, int& length) const
+{
+    double total = 0;
+    for (int i = 0; i < m_flen; i++)
+        total += std::norm(impulse[i]);
+
+    first = 0;
+    length = m_flen;
+    if (total == 0)
+        return;
+
+    const double target = total * (1.0 - MAX_TAIL_ENERGY);
+    double bestEdge = HUGE_VAL;
+    double sum = 0;
+    int end = 0;
+    for (int start = 0; start < m_flen; start++) {
+        while (sum < target && end - start < m_flen)
+            sum += std::norm(impulse[end++ % m_flen]);
+
+        const int n = end - start;
+        const double edge = std::norm(impulse[start]) + std::norm(impulse[(end - 1) % m_flen]);
+        if (n < length || (n == length && edge < bestEdge)) {
+            first = start;
+            length = n;
+            bestEdge = edge;
+        }
+        sum -= std::norm(impulse[start]);
+    }
+}
+
+//------------------------------------------------------------------------------
+// called whenever the filter response has changed. The channels shift the new
+// response to their frequencies with the next frame. In the partitioned mode the
+// taps of the partitions are taken from the support of the unshifted impulse
+// response, shifting only changes the phase of the taps, so all channels share
+// it and keep the same delay.
+//------------------------------------------------------------------------------
+void FFTFilter::updateResponse()
+{
+    for (size_t c = 0; c < m_channels.size(); c++)
+        m_channels[c].isResponseValid = false;
+
+    if (!m_partitions)
+        return;
+
+    m_fftPlanBackward->execute((const FFTComplex*)m_filter, m_fftWork);
+    int length;
+    findImpulseSupport((const std::complex<double>*)m_fftWork, m_impulseFirst, length);
+    m_impulsePartitions = std::min((length + m_blockSize - 1) / m_blockSize, m_partitions);
+}
+
 void FFTFilter::createFilter(double f1, double f2)
 {
     // initialize the filter to zero
@@ -140,16 +300,16 @@ void FFTFilter::createFilter(double f1, double f2)
     for (int i = 0; i < m_flen2; i++)
         m_ht[i] *= blackman(i, m_flen2);
 
-    // this may change since green fft is in place fft
-    memcpy(m_fftIn, m_ht, m_flen * sizeof(std::complex<double>));
+    // the input buffer holds samples, use the work buffer instead
+    memcpy(m_fftWork, m_ht, m_flen * sizeof(std::complex<double>));
 
     // ht is flen complex points with imaginary all zero
     // first half describes h(t), second half all zeros
     // perform the cmplx forward fft to obtain H(w)
     // filter is flen/2 complex values
 
-    fftw_execute(m_fftPlanForward);
-    memcpy(m_filter, m_fftOut, m_flen * sizeof(std::complex<double>));
+    updatePlans();
+    m_fftPlanForward->execute(m_fftWork, (FFTComplex*)m_filter);
 
     // normalize the output filter for unity gain
 	double scale = 0, mag;
@@ -163,6 +323,10 @@ void FFTFilter::createFilter(double f1, double f2)
             m_filter[i] /= scale;
 	}
 
+    // the channels of the filter bank shift the taps themselves
+    m_htScale = scale != 0 ? scale : 1.0;
+    m_rttyF = 0;
+
     // perform the reverse fft to obtain h(t)
     // for testing
     // uncomment to obtain filter characteristics
@@ -185,55 +349,438 @@ void FFTFilter::createFilter(double f1, double f2)
     fspec.close();
     delete [] revht;
     */
+    updateResponse();
     m_pass = 2;
 }
 
+//------------------------------------------------------------------------------
+// complex multiplication of whole spectra, written out on the interleaved
+// real and imaginary parts so the compiler can vectorize it
+//------------------------------------------------------------------------------
+
+static inline void multiplySpectrum(FFTComplex* out, const FFTComplex* a,
+                                    const FFTComplex* b, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const double re = a[i][0] * b[i][0] - a[i][1] * b[i][1];
+        const double im = a[i][0] * b[i][1] + a[i][1] * b[i][0];
+        out[i][0] = re;
+        out[i][1] = im;
+    }
+}
+
 /*
- * Filter with fast convolution (overlap-add algorithm).
+ * Filter with fast convolution (overlap-add algorithm). The output points into
+ * the filter and is valid until the next call.
  */
 
 int FFTFilter::run(const std::complex<double>& in, std::complex<double>** out)
 {
     // collect flen/2 input samples
-    m_timedata[m_inptr++] = in;
+    std::complex<double>* input = (std::complex<double>*)m_fftIn;
+    input[m_inptr++] = in;
 
     if (m_inptr < m_flen2)
 		return 0;
 
-    if (m_pass)
-        --m_pass; // filter output is not stable until 2 passes
+    if (!processFrame())
+        return 0;
 
-    // FFT transpose to the frequency domain
-    memcpy(m_fftIn, m_timedata, m_flen * sizeof(std::complex<double>));
-    fftw_execute(m_fftPlanForward);
+    *out = input;
+    return m_flen2;
+}
+
+/*
+ * Filter a block of samples. Complete frames are copied to out, which must have
+ * room for count + flen/2 samples. Returns the number of output samples.
+ */
 
-    for (int i = 0; i < m_flen; i++) {
-        std::complex<double>* out = (std::complex<double>*)&m_fftOut[i];
-        std::complex<double> res = *out * m_filter[i];
-        m_fftIn[i][0] = res.real();
-        m_fftIn[i][1] = res.imag();
+int FFTFilter::run(const std::complex<double>* in, int count, std::complex<double>* out)
+{
+    int n_out = 0;
+
+    while (count > 0) {
+        // collect up to flen/2 input samples at once
+        int n = std::min(count, m_flen2 - m_inptr);
+        memcpy(m_fftIn + m_inptr, in, n * sizeof(std::complex<double>));
+        m_inptr += n;
+        in += n;
+        count -= n;
+
+        if (m_inptr < m_flen2)
+            break;
+
+        if (processFrame()) {
+            memcpy(out + n_out, m_fftIn, m_flen2 * sizeof(std::complex<double>));
+            n_out += m_flen2;
+        }
     }
 
-    // transform back to time domain
-    fftw_execute(m_fftPlanBackward);
-    memcpy(m_freqdata, m_fftOut, m_flen * sizeof(std::complex<double>));
+    return n_out;
+}
+
+/*
+ * Filter one frame of flen/2 collected input samples, returns true if the output
+ * in the first half of m_fftIn is valid.
+ */
+
+bool FFTFilter::processFrame()
+{
+    if (m_pass)
+        --m_pass; // filter output is not stable until 2 passes
+
+    // FFT transpose to the frequency domain, multiply with the filter response
+    // and transform back to time domain
+    updatePlans();
+    m_fftPlanForward->execute(m_fftIn, m_fftOut);
+    multiplySpectrum(m_fftOut, m_fftOut, (const FFTComplex*)m_filter, m_flen);
+    m_fftPlanBackward->execute(m_fftOut, m_fftIn);
 
     // overlap and add
     // save the second half for overlapping next inverse FFT
-    for (int i = 0; i < m_flen2; i++) {
-        m_output[i] = m_ovlbuf[i] + m_freqdata[i];
-        m_ovlbuf[i] = m_freqdata[i + m_flen2];
-	}
+    overlapAdd((std::complex<double>*)m_fftIn, m_ovlbuf, m_flen2);
 
     // clear inbuf pointer
     m_inptr = 0;
 
     // signal the caller there is flen/2 samples ready
-    if (m_pass)
-        return 0;
+    return m_pass == 0;
+}
 
-    *out = m_output;
-    return m_flen2;
+/*
+ * Adds the overlap of the previous frame to the first half of the result of
+ * 2 * half samples in m_fftIn and saves the second half as overlap for the next
+ * one. The second half of m_fftIn is cleared afterwards for the next input frame.
+ */
+
+void FFTFilter::overlapAdd(std::complex<double>* output, std::complex<double>* ovlbuf, int half)
+{
+    const std::complex<double>* result = (const std::complex<double>*)m_fftIn;
+    for (int i = 0; i < half; i++)
+        output[i] = ovlbuf[i] + result[i];
+    memcpy(ovlbuf, result + half, half * sizeof(std::complex<double>));
+    if (half > m_flen2 / 2)
+        memset(m_fftIn + m_flen2, 0, (2 * half - m_flen2) * sizeof(FFTComplex));
+}
+
+//------------------------------------------------------------------------------
+// filter bank
+//
+// Mixing a signal down by f and filtering it with h is the same as filtering it
+// with h shifted up by f and mixing the result down afterwards. Shifting the
+// filter moves the filter response by f * flen bins, so a single forward FFT of
+// the input can be shared by all channels. Each channel needs its own product and
+// inverse FFT, as the channel outputs are complex.
+//
+// The shift is not rounded to whole bins, as a bin of the rtty filter is a large
+// part of its passband at high sample rates. Each channel keeps the response at
+// its exact frequency: the windowed sinc taps are modulated with exp(j*2*pi*f*t)
+// and transformed, the rtty response is evaluated at the fractional bins. It is
+// recomputed when the channel has moved by more than MAX_RESPONSE_DRIFT bins. The
+// caller mixes the outputs down by the exact channel frequencies.
+//
+// The channel outputs can be decimated by a factor D that divides flen/2.
+// Folding the product into flen/D bins before the inverse FFT yields every D-th
+// output sample exactly, with an inverse FFT of a D-th of the size. Only the
+// bins where the filter response is not zero are multiplied.
+//
+// Overlap-add delivers output in frames of flen/2 samples, after two frames of
+// warm-up. With a block size B below flen/2 the bank uses uniformly partitioned
+// overlap-save convolution instead: the flen taps of the impulse response are
+// split into P = flen/B partitions of B taps, each channel keeps the spectra of
+// its shifted partitions. Every block of B samples is transformed once with the
+// previous block in front of it, the last P input spectra are kept in a
+// frequency domain delay line and each channel sums their products with its
+// partitions. The second half of the inverse FFT is the output, so the latency
+// is B samples instead of flen/2 and output starts with the first block. The
+// partitions are rebuilt with the shifted response. They start at the first tap
+// of the support of the impulse response, which adds the taps in front of its
+// peak to the delay, and partitions past its end are skipped.
+//------------------------------------------------------------------------------
+
+void FFTFilter::setChannels(int channels)
+{
+    m_channels.resize(channels);
+    for (size_t c = 0; c < m_channels.size(); c++) {
+        m_channels[c].ovlbuf.assign(m_flen2 / m_decimation, std::complex<double>(0, 0));
+        m_channels[c].isResponseValid = false;
+    }
+
+    memset(m_fftIn, 0, m_flen * sizeof(FFTComplex));
+    memset(m_realIn, 0, m_flen * sizeof(double));
+    if (m_partitions)
+        memset(m_fdl, 0, m_partitions * 2 * m_blockSize * sizeof(FFTComplex));
+    m_fdlPos = 0;
+    m_inptr = 0;
+    m_pass = 2;
+}
+
+// the decimation is rounded down to the next divisor of the block size
+void FFTFilter::setDecimation(int decimation)
+{
+    decimation = std::max(1, std::min(decimation, m_blockSize));
+    while (m_blockSize % decimation != 0)
+        --decimation;
+
+    m_decimation = decimation;
+    m_planGeneration = -1;
+    updatePlans();
+    setChannels((int)m_channels.size());
+}
+
+// blocks below flen/2 select the partitioned overlap-save mode, the block size is
+// rounded down to the next divisor of flen/2 and the decimation to a divisor of it.
+// There is room for partitions over all flen taps, at high sample rates the rtty
+// response does not fit into flen/2 taps.
+void FFTFilter::setBlockSize(int blockSize)
+{
+    blockSize = std::max(1, std::min(blockSize, m_flen2));
+    while (m_flen2 % blockSize != 0)
+        --blockSize;
+
+    m_blockSize = blockSize;
+    m_partitions = blockSize < m_flen2 ? m_flen / blockSize : 0;
+
+    FFT::release(m_fdl);
+    m_fdl = 0;
+    if (m_partitions)
+        m_fdl = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_partitions * 2 * blockSize);
+
+    // the partitions are built with the response
+    updateResponse();
+
+    setDecimation(m_decimation);
+}
+
+// f is the channel frequency normalized to the sample rate, small changes keep
+// the shifted response
+void FFTFilter::setChannelFrequency(int channel, double f)
+{
+    Channel& c = m_channels[channel];
+    c.frequency = f;
+    if (fabs(f - c.responseFrequency) * m_flen > MAX_RESPONSE_DRIFT)
+        c.isResponseValid = false;
+}
+
+//------------------------------------------------------------------------------
+// shift the filter response to the channels that have moved, called before the
+// frame is transformed as it uses the work buffers
+//------------------------------------------------------------------------------
+void FFTFilter::updateChannels()
+{
+    for (size_t c = 0; c < m_channels.size(); c++) {
+        Channel& channel = m_channels[c];
+        if (channel.isResponseValid)
+            continue;
+
+        channel.response.resize(m_flen);
+        if (m_rttyF > 0) {
+            const double shift = channel.frequency * m_flen;
+            for (int k = 0; k < m_flen; k++) {
+                double bin = fmod(k - shift, (double)m_flen);
+                if (bin < -m_flen2)
+                    bin += m_flen;
+                else if (bin >= m_flen2)
+                    bin -= m_flen;
+                channel.response[k] = rttyResponse(bin);
+            }
+        } else {
+            // the spectrum of the modulated taps is the response shifted by f
+            std::complex<double>* taps = (std::complex<double>*)m_fftWork;
+            std::fill(taps, taps + m_flen, std::complex<double>(0, 0));
+            for (int t = 0; t < m_flen2; t++) {
+                const double phase = 2.0 * M_PI * fmod(channel.frequency * t, 1.0);
+                taps[t] = m_ht[t] * std::polar(1.0 / m_htScale, phase);
+            }
+            m_fftPlanForward->execute(m_fftWork, m_fftOut);
+            const std::complex<double>* response = (const std::complex<double>*)m_fftOut;
+            std::copy(response, response + m_flen, channel.response.begin());
+        }
+
+        findSupport(&channel.response[0], channel.supportFirst, channel.supportLength);
+        if (m_partitions)
+            updatePartitions(c);
+        channel.responseFrequency = channel.frequency;
+        channel.isResponseValid = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+// partition p holds taps p*B ... p*B+B-1 of the shifted impulse response counted
+// from the first tap of its support, scaled by 1/(2B) so the gain matches
+// overlap-add. The rtty response is centred at tap flen/4 and wraps around the
+// frame, the support keeps only as much of it in front of the peak as it needs.
+//------------------------------------------------------------------------------
+void FFTFilter::updatePartitions(int c)
+{
+    Channel& channel = m_channels[c];
+    const int frame = 2 * m_blockSize;
+    const std::complex<double>* response = &channel.response[0];
+    std::copy(response, response + m_flen, (std::complex<double>*)m_fftWork);
+    m_fftPlanBackward->execute(m_fftWork, m_fftOut);
+    const std::complex<double>* impulse = (const std::complex<double>*)m_fftOut;
+    std::rotate_copy(impulse, impulse + m_impulseFirst, impulse + m_flen, m_impulse);
+
+    channel.partitions.resize(m_impulsePartitions * frame);
+    const double scale = 1.0 / frame;
+    for (int p = 0; p < m_impulsePartitions; p++) {
+        std::complex<double>* taps = (std::complex<double>*)m_fftWork;
+        std::fill(taps, taps + frame, std::complex<double>(0, 0));
+        for (int i = 0; i < m_blockSize; i++)
+            taps[i] = m_impulse[p * m_blockSize + i] * scale;
+        m_fftPlanBlock->execute(m_fftWork, m_fftOut);
+        const std::complex<double>* spectrum = (const std::complex<double>*)m_fftOut;
+        std::copy(spectrum, spectrum + frame, &channel.partitions[p * frame]);
+    }
+}
+
+/*
+ * Filter a block of real samples for all channels. out contains one buffer per
+ * channel with room for (count + block size) / decimation samples. Returns the
+ * number of output samples per channel. The spectrum of a real frame is
+ * hermitian, so a real-to-complex FFT of half the size of the complex transform
+ * provides all bins.
+ */
+
+int FFTFilter::runChannels(const double* in, int count, std::complex<double>* const* out)
+{
+    int n_out = 0;
+
+    double* input = m_realIn;
+    if (m_partitions)
+        input += m_blockSize;
+
+    while (count > 0) {
+        int n = std::min(count, m_blockSize - m_inptr);
+        memcpy(input + m_inptr, in, n * sizeof(double));
+        m_inptr += n;
+        in += n;
+        count -= n;
+
+        if (m_inptr < m_blockSize)
+            break;
+
+        m_inptr = 0;
+        updatePlans();
+        updateChannels();
+
+        if (m_partitions) {
+            const int frame = 2 * m_blockSize;
+            std::complex<double>* spectrum = (std::complex<double>*)nextPartition();
+            m_fftPlanBlockReal->execute(m_realIn, (FFTComplex*)spectrum);
+            for (int i = m_blockSize + 1; i < frame; i++)
+                spectrum[i] = std::conj(spectrum[frame - i]);
+            memcpy(m_realIn, input, m_blockSize * sizeof(double));
+
+            filterPartitioned(out, n_out);
+            n_out += m_blockSize / m_decimation;
+            continue;
+        }
+
+        if (m_pass)
+            --m_pass;
+
+        // shared forward FFT, the upper half of the spectrum is the conjugate mirror
+        m_fftPlanReal->execute(m_realIn, m_fftOut);
+        std::complex<double>* spectrum = (std::complex<double>*)m_fftOut;
+        for (int i = m_flen2 + 1; i < m_flen; i++)
+            spectrum[i] = std::conj(spectrum[m_flen - i]);
+
+        filterChannels(out, n_out);
+
+        if (!m_pass)
+            n_out += m_flen2 / m_decimation;
+    }
+
+    return n_out;
+}
+
+/*
+ * Filters the spectrum in m_fftOut for all channels, the outputs are written to
+ * out at offset n_out.
+ */
+
+void FFTFilter::filterChannels(std::complex<double>* const* out, int n_out)
+{
+    const int size = m_flen / m_decimation;
+    const FFTComplex* spectrum = m_fftOut;
+
+    for (size_t c = 0; c < m_channels.size(); c++) {
+        Channel& channel = m_channels[c];
+        const FFTComplex* filter = (const FFTComplex*)&channel.response[0];
+
+        // multiply the supported bins with the shifted filter response and fold
+        // the product into size bins
+        memset(m_fftWork, 0, size * sizeof(FFTComplex));
+
+        int bin = channel.supportFirst;
+        int fold = bin % size;
+
+        for (int i = 0; i < channel.supportLength; i++) {
+            m_fftWork[fold][0] += spectrum[bin][0] * filter[bin][0] - spectrum[bin][1] * filter[bin][1];
+            m_fftWork[fold][1] += spectrum[bin][0] * filter[bin][1] + spectrum[bin][1] * filter[bin][0];
+
+            if (++bin == m_flen)
+                bin = 0;
+            if (++fold == size)
+                fold = 0;
+        }
+
+        m_fftPlanDecimated->execute(m_fftWork, m_fftIn);
+        overlapAdd(out[c] + n_out, &channel.ovlbuf[0], size / 2);
+    }
+}
+
+/*
+ * Advances the frequency domain delay line and returns the slot for the spectrum
+ * of the newest frame, it replaces the oldest one.
+ */
+
+FFTComplex* FFTFilter::nextPartition()
+{
+    if (++m_fdlPos == m_partitions)
+        m_fdlPos = 0;
+    return m_fdl + m_fdlPos * 2 * m_blockSize;
+}
+
+/*
+ * Partitioned overlap-save for all channels: sums the products of the delayed
+ * input spectra and the shifted partitions, folded for the decimation, and keeps
+ * the second half of the inverse FFT. The outputs are written to out at offset
+ * n_out.
+ */
+
+void FFTFilter::filterPartitioned(std::complex<double>* const* out, int n_out)
+{
+    const int frame = 2 * m_blockSize;
+    const int size = frame / m_decimation;
+
+    for (size_t c = 0; c < m_channels.size(); c++) {
+        Channel& channel = m_channels[c];
+        memset(m_fftWork, 0, size * sizeof(FFTComplex));
+
+        const FFTComplex* filter = (const FFTComplex*)&channel.partitions[0];
+        int pos = m_fdlPos;
+        for (int p = 0; p < m_impulsePartitions; p++) {
+            const FFTComplex* spectrum = m_fdl + pos * frame;
+            int fold = 0;
+            for (int k = 0; k < frame; k++) {
+                m_fftWork[fold][0] += spectrum[k][0] * filter[k][0] - spectrum[k][1] * filter[k][1];
+                m_fftWork[fold][1] += spectrum[k][0] * filter[k][1] + spectrum[k][1] * filter[k][0];
+                if (++fold == size)
+                    fold = 0;
+            }
+
+            filter += frame;
+            if (--pos < 0)
+                pos = m_partitions - 1;
+        }
+
+        // the first half of the circular result is aliased
+        m_fftPlanDecimated->execute(m_fftWork, m_fftOut);
+        const std::complex<double>* result = (const std::complex<double>*)m_fftOut;
+        std::copy(result + size / 2, result + size, out[c] + n_out);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -260,30 +807,13 @@ void FFTFilter::rttyFilter(double f)
     //   1.5   .0062
     //   1.6   .0076
 
-	f *= 1.4;
-
-	double dht;
-    for(int i = 0; i < m_flen2; ++i) {
-        double x = (double)i / (double)(m_flen2);
-
-        // raised cosine response (changed for -1.0...+1.0 times Nyquist-f
-        // instead of books versions ranging from -1..+1 times samplerate)
-
-		dht =
-			x <= 0 ? 1.0 :
-			x > 2.0 * f ? 0.0 :
-			cos((M_PI * x) / (f * 4.0));
+    m_rttyF = f * 1.4;
 
-		dht *= dht; // cos^2
-
-        // amplitude equalized nyquist-channel response
-		dht /= sinc(2.0 * i * f);
-
-        m_filter[i] = std::complex<double>(dht * cos((double)i * -0.5 * M_PI),
-                                           dht * sin((double)i * -0.5 * M_PI));
-
-        m_filter[(m_flen-i) % m_flen] = std::complex<double>(dht * cos((double)i * +0.5 * M_PI),
-                                                             dht * sin((double)i * +0.5 * M_PI));
+    // the response is defined for fractional bins as well, so the channels of the
+    // filter bank evaluate it at their exact frequency
+    for (int i = 0; i < m_flen2; ++i) {
+        m_filter[i] = rttyResponse(i);
+        m_filter[(m_flen-i) % m_flen] = rttyResponse(-i);
 	}
 
     // perform the reverse fft to obtain h(t)
@@ -307,6 +837,10 @@ void FFTFilter::rttyFilter(double f)
     fspec.close();
     delete [] revht;
     */
+    // the nyquist bin is not part of the response
+    m_filter[m_flen2] = 0;
+    updateResponse();
+
     // start outputs after 2 full passes are complete
     m_pass = 2;
 }
@@ -6,7 +6,8 @@
 #define	FFTFILT_H
 
 #include <complex>
-#include <fftw/fftw3.h>
+#include <vector>
+#include "fftbackend.h"
 
 class FFTFilter {
 public:
@@ -26,9 +27,40 @@ public:
     void rttyFilter(double);
 
     int run(const std::complex<double>& in, std::complex<double>** out);
+    int run(const std::complex<double>* in, int count, std::complex<double>* out);
+
+    int getLength() const {
+        return m_flen;
+    }
+
+    // filter bank mode: one forward FFT of the input feeds several channels, each
+    // using the filter response shifted up to the exact channel frequency
+    void setChannels(int channels);
+    void setChannelFrequency(int channel, double f);
+    void setDecimation(int decimation);
+    int getDecimation() const {
+        return m_decimation;
+    }
+    void setBlockSize(int blockSize);
+    int getBlockSize() const {
+        return m_blockSize;
+    }
+    int runChannels(const double* in, int count, std::complex<double>* const* out);
 
 private:
     void initFilter();
+    void updatePlans();
+    void findSupport(const std::complex<double>* response, int& first, int& length) const;
+    void findImpulseSupport(const std::complex<double>* impulse, int& first, int& length) const;
+    void updateResponse();
+    void updateChannels();
+    void updatePartitions(int c);
+    std::complex<double> rttyResponse(double bin) const;
+    bool processFrame();
+    void overlapAdd(std::complex<double>* output, std::complex<double>* ovlbuf, int half);
+    void filterChannels(std::complex<double>* const* out, int n_out);
+    Digital::Internal::FFTComplex* nextPartition();
+    void filterPartitioned(std::complex<double>* const* out, int n_out);
     inline double fsinc(double fc, int i, int len) {
         return (i == len/2) ? 2.0 * fc:
                 sin(2 * M_PI * fc * (i - len/2)) / (M_PI * (i - len/2));
@@ -39,23 +71,56 @@ private:
                  0.08 * cos(4.0 * M_PI * i / len));
     }
 
+    static const double MAX_RESPONSE_DRIFT;    // in bins
+    static const double MAX_TAIL_ENERGY;       // relative to the impulse response
+
     int m_flen;
     int m_flen2;
 
-    fftw_complex*   m_fftIn;
-    fftw_complex*   m_fftOut;
-    fftw_plan       m_fftPlanForward;
-    fftw_plan       m_fftPlanBackward;
+    Digital::Internal::FFTComplex*  m_fftIn;
+    Digital::Internal::FFTComplex*  m_fftOut;
+    Digital::Internal::FFTComplex*  m_fftWork;
+    const Digital::Internal::FFT*   m_fftPlanForward;
+    const Digital::Internal::FFT*   m_fftPlanBackward;
+    double*                         m_realIn;
+    const Digital::Internal::FFT*   m_fftPlanReal;
+    const Digital::Internal::FFT*   m_fftPlanDecimated;
+    const Digital::Internal::FFT*   m_fftPlanBlock;
+    const Digital::Internal::FFT*   m_fftPlanBlockReal;
+    int             m_planGeneration;
 
     std::complex<double>* m_ht;
     std::complex<double>* m_filter;
-    std::complex<double>* m_timedata;
-    std::complex<double>* m_freqdata;
     std::complex<double>* m_ovlbuf;
-    std::complex<double>* m_output;
     int m_inptr;
     int m_pass;
     int m_window;
+
+    struct Channel {
+        Channel() : frequency(0), responseFrequency(0), isResponseValid(false),
+            supportFirst(0), supportLength(0) {}
+        double frequency;                           // normalized to the sample rate
+        double responseFrequency;                   // frequency the response is shifted to
+        bool isResponseValid;
+        std::vector<std::complex<double> > response;    // filter response at the channel
+        int supportFirst;                           // first non-zero bin of the response
+        int supportLength;                          // bins from there with all non-zero bins
+        std::vector<std::complex<double> > ovlbuf;  // second half of the previous frame
+        std::vector<std::complex<double> > partitions;  // spectra of the shifted response
+    };
+    std::vector<Channel> m_channels;
+    int m_decimation;
+    double m_htScale;       // normalization of the taps in m_ht
+    double m_rttyF;         // scaled bandwidth of the rtty filter, 0 if m_ht holds the taps
+
+    // uniformly partitioned overlap-save mode of the filter bank
+    int m_blockSize;        // input samples per frame, flen/2 in overlap-add mode
+    int m_partitions;       // number of partitions, 0 in overlap-add mode
+    int m_impulseFirst;     // first tap of the impulse response in the partitions
+    int m_impulsePartitions;    // partitions that hold its support
+    int m_fdlPos;           // newest input spectrum in the delay line
+    Digital::Internal::FFTComplex* m_fdl;   // spectra of the last m_partitions frames
+    std::complex<double>* m_impulse;        // taps of a shifted impulse response
 };
 
 #endif
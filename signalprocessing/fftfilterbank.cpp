@@ -0,0 +1,164 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+#include "fftfilterbank.h"
+
+using namespace Digital::Internal;
+
+FFTFilterBank::FFTFilterBank(double sampleRate, int filterLength)
+    : m_sampleRate(sampleRate)
+{
+    m_filter = new FFTFilter(0.5, filterLength);
+}
+
+FFTFilterBank::~FFTFilterBank()
+{
+    delete m_filter;
+}
+
+/**
+ * @brief Uses the raised cosine RTTY filter for the given baud rate as channel response
+ */
+void FFTFilterBank::rttyFilter(double baud)
+{
+    m_filter->rttyFilter(baud / m_sampleRate);
+}
+
+/**
+ * @brief Uses a lowpass with the given cutoff frequency in Hz as channel response
+ */
+void FFTFilterBank::createLPF(double frequency)
+{
+    m_filter->createLPF(frequency / m_sampleRate);
+}
+
+/**
+ * @brief Sets the number of channels, this clears the filter state
+ */
+void FFTFilterBank::setChannels(int channels)
+{
+    m_filter->setChannels(channels);
+    m_oscillators.assign(channels, NCO(getOutputRate()));
+}
+
+int FFTFilterBank::getChannels() const
+{
+    return (int)m_oscillators.size();
+}
+
+/**
+ * @brief Sets the center frequency of a channel in Hz. This may be changed between blocks,
+ * the baseband phase continues without a jump.
+ */
+void FFTFilterBank::setChannelFrequency(int channel, double frequency)
+{
+    m_filter->setChannelFrequency(channel, frequency / m_sampleRate);
+    m_oscillators[channel].setFrequency(frequency);
+}
+
+double FFTFilterBank::getChannelFrequency(int channel) const
+{
+    return m_oscillators[channel].getFrequency();
+}
+
+/**
+ * @brief Sets the number of input samples after which output is delivered, this clears the
+ * filter state. Half the filter length or more selects overlap-add.
+ */
+void FFTFilterBank::setBlockSize(int blockSize)
+{
+    m_filter->setBlockSize(blockSize);
+    resetOscillators();
+}
+
+int FFTFilterBank::getBlockSize() const
+{
+    return m_filter->getBlockSize();
+}
+
+/**
+ * @brief Sets the decimation of the channel outputs, this clears the filter state
+ */
+void FFTFilterBank::setDecimation(int decimation)
+{
+    m_filter->setDecimation(decimation);
+    resetOscillators();
+}
+
+int FFTFilterBank::getDecimation() const
+{
+    return m_filter->getDecimation();
+}
+
+/**
+ * @brief Returns the filter length, the passband gain of the channels is the same
+ */
+int FFTFilterBank::getLength() const
+{
+    return m_filter->getLength();
+}
+
+double FFTFilterBank::getSampleRate() const
+{
+    return m_sampleRate;
+}
+
+double FFTFilterBank::getOutputRate() const
+{
+    return m_sampleRate / m_filter->getDecimation();
+}
+
+/**
+ * @brief Returns the number of samples each output buffer must have room for when run() is
+ * called with count input samples
+ */
+int FFTFilterBank::getMaxOutput(int count) const
+{
+    return (count + m_filter->getBlockSize()) / m_filter->getDecimation() + 1;
+}
+
+/**
+ * @brief Filters a block of real samples. out contains one buffer per channel with room for
+ * getMaxOutput(count) samples. Returns the number of baseband samples per channel.
+ */
+int FFTFilterBank::run(const double* in, int count, std::complex<double>* const* out)
+{
+    const int n_out = m_filter->runChannels(in, count, out);
+
+    // The filter has shifted the response to the channel frequency, the channel is still
+    // at f. The oscillators run at the output rate and hit the same phases as at the input
+    // rate, so mixing after decimation removes the exact channel frequency.
+    for (size_t c = 0; c < m_oscillators.size(); c++)
+        m_oscillators[c].mixDown(out[c], out[c], n_out);
+
+    return n_out;
+}
+
+void FFTFilterBank::resetOscillators()
+{
+    for (size_t c = 0; c < m_oscillators.size(); c++) {
+        m_oscillators[c].setSampleRate(getOutputRate());
+        m_oscillators[c].reset();
+    }
+}
@@ -0,0 +1,85 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+#ifndef FFTFILTERBANK_H
+#define FFTFILTERBANK_H
+
+#include "fftfilter.h"
+#include "nco.h"
+#include <complex>
+#include <vector>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The FFTFilterBank class filters one real input stream into a number of channels at
+ * arbitrary frequencies and returns their decimated baseband signals. There is one forward FFT
+ * per block for all channels, each channel adds a product over the filter's passband and an
+ * inverse FFT reduced by the decimation factor, followed by mixing down to baseband.
+ *
+ * By default the filter runs overlap-add on frames of half the filter length. A smaller block
+ * size switches to partitioned overlap-save convolution with the same filter response, which
+ * delivers output every block at a higher CPU cost.
+ *
+ * The block size is rounded down to a divisor of half the filter length and the decimation
+ * factor to a divisor of the block size.
+ */
+class FFTFilterBank
+{
+public:
+    FFTFilterBank(double sampleRate, int filterLength = 1024);
+    ~FFTFilterBank();
+
+    void rttyFilter(double baud);
+    void createLPF(double frequency);
+
+    void setChannels(int channels);
+    int getChannels() const;
+    void setChannelFrequency(int channel, double frequency);
+    double getChannelFrequency(int channel) const;
+
+    void setBlockSize(int blockSize);
+    int getBlockSize() const;
+    void setDecimation(int decimation);
+    int getDecimation() const;
+    int getLength() const;
+    double getSampleRate() const;
+    double getOutputRate() const;
+    int getMaxOutput(int count) const;
+
+    int run(const double* in, int count, std::complex<double>* const* out);
+
+private:
+    void resetOscillators();
+
+    double              m_sampleRate;
+    FFTFilter*          m_filter;
+    std::vector<NCO>    m_oscillators;  // mix the channels down at the output rate
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // FFTFILTERBANK_H
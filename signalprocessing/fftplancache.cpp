@@ -0,0 +1,257 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+#include "fftplancache.h"
+#include <QThread>
+#include <QDebug>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief Low priority thread that replaces estimated plans by measured ones
+ */
+class FFTPlannerThread
+        : public QThread
+{
+public:
+    FFTPlannerThread(FFTPlanCache* cache)
+        : m_cache(cache)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_cache->planQueued();
+    }
+
+private:
+    FFTPlanCache* m_cache;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+using namespace Digital::Internal;
+
+FFTPlanCache::FFTPlanCache()
+    : m_backend(FFTBackend::create(FFTBackend::getDefaultName())),
+      m_backgroundPlanning(false),
+      m_backgroundEffort(FFTBackend::EFFORT_ESTIMATE),
+      m_terminate(false),
+      m_generation(0),
+      m_thread(0)
+{
+}
+
+FFTPlanCache::~FFTPlanCache()
+{
+    clear();
+    delete m_thread;
+    delete m_backend;
+}
+
+FFTPlanCache& FFTPlanCache::instance()
+{
+    static FFTPlanCache cache;
+    return cache;
+}
+
+/**
+ * @brief Replaces the backend that creates the plans and takes ownership of it. All plans
+ * are destroyed, so this should be done at startup before any plan is in use.
+ */
+void FFTPlanCache::setBackend(FFTBackend* backend)
+{
+    if (!backend)
+        return;
+
+    clear();
+
+    QMutexLocker plannerLock(&m_plannerMutex);
+    delete m_backend;
+    m_backend = backend;
+}
+
+QString FFTPlanCache::getBackendName() const
+{
+    QMutexLocker plannerLock(&m_plannerMutex);
+    return m_backend->getName();
+}
+
+/**
+ * @brief Returns the shared plan for a transform, it is created if it does not exist yet.
+ * The plan is owned by the cache.
+ */
+const FFT* FFTPlanCache::getPlan(FFT::Type type, int size)
+{
+    const Key key(type, size);
+
+    QMutexLocker lock(&m_mutex);
+    FFT* plan = m_plans.value(key, 0);
+    if (plan)
+        return plan;
+    lock.unlock();
+
+    // estimating a plan is fast, the background thread replaces it later on
+    plan = createPlan(key, FFTBackend::EFFORT_ESTIMATE);
+    if (!plan)
+        return 0;
+
+    lock.relock();
+    FFT* existing = m_plans.value(key, 0);
+    if (existing) {
+        // another thread was faster
+        m_retired.append(plan);
+        return existing;
+    }
+
+    m_plans.insert(key, plan);
+    if (m_backgroundPlanning) {
+        m_queue.append(key);
+        m_queueChanged.wakeAll();
+    }
+
+    return plan;
+}
+
+/**
+ * @brief Returns a counter that changes whenever plans have been replaced
+ */
+int FFTPlanCache::getGeneration() const
+{
+    return m_generation.loadAcquire();
+}
+
+bool FFTPlanCache::importWisdom(const QString& fileName)
+{
+    QMutexLocker lock(&m_plannerMutex);
+    return m_backend->importWisdom(fileName);
+}
+
+bool FFTPlanCache::exportWisdom(const QString& fileName)
+{
+    QMutexLocker lock(&m_plannerMutex);
+    return m_backend->exportWisdom(fileName);
+}
+
+/**
+ * @brief Plans all existing and all future plans again with the given effort in a low
+ * priority thread. Nothing is done if the backend does not benefit from it.
+ */
+void FFTPlanCache::startBackgroundPlanning(FFTBackend::Effort effort)
+{
+    m_plannerMutex.lock();
+    const bool tunable = m_backend->isTunable();
+    m_plannerMutex.unlock();
+    if (!tunable || effort == FFTBackend::EFFORT_ESTIMATE)
+        return;
+
+    QMutexLocker lock(&m_mutex);
+
+    m_backgroundPlanning = true;
+    m_backgroundEffort = effort;
+    m_terminate = false;
+    m_queue = m_plans.keys();
+
+    if (!m_thread)
+        m_thread = new FFTPlannerThread(this);
+    if (!m_thread->isRunning())
+        m_thread->start(QThread::LowPriority);
+
+    m_queueChanged.wakeAll();
+}
+
+/**
+ * @brief Stops background planning and waits until a plan in progress is finished
+ */
+void FFTPlanCache::stopBackgroundPlanning()
+{
+    m_mutex.lock();
+    m_backgroundPlanning = false;
+    m_terminate = true;
+    m_queue.clear();
+    m_queueChanged.wakeAll();
+    m_mutex.unlock();
+
+    if (m_thread)
+        m_thread->wait();
+}
+
+/**
+ * @brief Destroys all plans. No plan of the cache may be in use at this time.
+ */
+void FFTPlanCache::clear()
+{
+    stopBackgroundPlanning();
+
+    QMutexLocker lock(&m_mutex);
+    QMutexLocker plannerLock(&m_plannerMutex);
+
+    qDeleteAll(m_plans);
+    qDeleteAll(m_retired);
+
+    m_plans.clear();
+    m_retired.clear();
+    m_generation.fetchAndAddOrdered(1);
+}
+
+FFT* FFTPlanCache::createPlan(const Key& key, FFTBackend::Effort effort)
+{
+    QMutexLocker lock(&m_plannerMutex);
+
+    FFT* plan = m_backend->createFFT((FFT::Type)key.first, key.second, effort);
+    if (!plan)
+        qWarning() << "could not create FFT plan of size" << key.second << "with" << m_backend->getName();
+
+    return plan;
+}
+
+void FFTPlanCache::planQueued()
+{
+    QMutexLocker lock(&m_mutex);
+
+    while (!m_terminate) {
+        if (m_queue.isEmpty()) {
+            m_queueChanged.wait(&m_mutex);
+            continue;
+        }
+
+        const Key key = m_queue.takeFirst();
+        const FFTBackend::Effort effort = m_backgroundEffort;
+
+        lock.unlock();
+        FFT* plan = createPlan(key, effort);
+        lock.relock();
+
+        if (plan) {
+            // the old plan may still be executed by its users, it is kept until clear()
+            if (m_plans.contains(key))
+                m_retired.append(m_plans.value(key));
+            m_plans.insert(key, plan);
+            m_generation.fetchAndAddOrdered(1);
+        }
+    }
+}
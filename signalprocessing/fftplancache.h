@@ -0,0 +1,99 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+#ifndef FFTPLANCACHE_H
+#define FFTPLANCACHE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QPair>
+#include <QList>
+#include <QString>
+#include <QAtomicInt>
+#include "fftbackend.h"
+
+namespace Digital {
+namespace Internal {
+
+class FFTPlannerThread;
+
+/**
+ * @brief The FFTPlanCache class is a process-wide registry of FFT plans. A plan is created
+ * once per transform type and size and shared by all users, it can be executed on any arrays
+ * allocated with FFT::allocate(). The plans are created by the selected FFT backend.
+ *
+ * Planning is not thread-safe, so all planning of the application goes through this class.
+ * Missing plans are created with the lowest effort, which also picks up imported wisdom.
+ * When background planning is enabled, every plan is planned again with a higher effort in
+ * a background thread and replaces the estimated one. Replaced plans stay valid until the
+ * cache is cleared, users notice the replacement by a changed generation.
+ */
+class FFTPlanCache
+{
+public:
+    static FFTPlanCache& instance();
+
+    void setBackend(FFTBackend* backend);
+    QString getBackendName() const;
+
+    const FFT* getPlan(FFT::Type type, int size);
+    int getGeneration() const;
+
+    bool importWisdom(const QString& fileName);
+    bool exportWisdom(const QString& fileName);
+
+    void startBackgroundPlanning(FFTBackend::Effort effort);
+    void stopBackgroundPlanning();
+
+    void clear();
+
+private:
+    friend class FFTPlannerThread;
+    typedef QPair<int, int> Key;    // type and size
+
+    FFTPlanCache();
+    ~FFTPlanCache();
+
+    FFT* createPlan(const Key& key, FFTBackend::Effort effort);
+    void planQueued();
+
+    mutable QMutex              m_mutex;            // protects everything but the planner
+    mutable QMutex              m_plannerMutex;     // serializes all calls to the backend
+    QWaitCondition              m_queueChanged;
+    FFTBackend*                 m_backend;
+    QHash<Key, FFT*>            m_plans;
+    QList<FFT*>                 m_retired;          // replaced plans, possibly still in use
+    QList<Key>                  m_queue;            // plans waiting for background planning
+    bool                        m_backgroundPlanning;
+    FFTBackend::Effort          m_backgroundEffort;
+    bool                        m_terminate;
+    QAtomicInt                  m_generation;
+    FFTPlannerThread*           m_thread;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // FFTPLANCACHE_H
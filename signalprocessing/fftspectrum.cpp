@@ -33,15 +33,14 @@
 
 using namespace Digital::Internal;
 
-FFTSpectrum::FFTSpectrum(int fftSize, FFTWindow wdType, QObject* parent)
+FFTSpectrum::FFTSpectrum(int fftSize, int hopSize, FFTWindow wdType, QObject* parent)
     : AudioConsumer(parent, 512),
       m_fftSize(fftSize),
       m_fftWorker(0),
-      m_fftThread(0),
-      m_buffer(0)
+      m_fftThread(0)
 {
     m_fftThread = new QThread(this);
-    m_fftWorker = new FFTSpectrumWorker(fftSize, wdType);
+    m_fftWorker = new FFTSpectrumWorker(fftSize, hopSize, wdType);
     m_fftWorker->moveToThread(m_fftThread);
 
     connect(m_fftThread, &QThread::started, m_fftWorker, &FFTSpectrumWorker::run);
@@ -49,6 +48,10 @@ FFTSpectrum::FFTSpectrum(int fftSize, FFTWindow wdType, QObject* parent)
     connect(m_fftWorker, &FFTSpectrumWorker::finished, m_fftWorker, &FFTSpectrumWorker::deleteLater);
     connect(m_fftThread, &QThread::finished, m_fftThread, &QThread::deleteLater);
     connect(m_fftWorker, &FFTSpectrumWorker::dataReady, this, &FFTSpectrum::spectrumReady);
+
+    // the signals of this class carry the magnitude and the log spectrum, modems query the
+    // band power
+    setOutputs(OUTPUT_MAGNITUDE | OUTPUT_LOG | OUTPUT_BAND_POWER);
 }
 
 FFTSpectrum::~FFTSpectrum()
@@ -65,44 +68,80 @@ void FFTSpectrum::init()
         m_fftThread->start();
 }
 
-void FFTSpectrum::registered()
+/**
+ * @brief Selects the spectrum representations that are computed, a combination of FFTOutput
+ * flags. Only the signals of the selected representations are emitted.
+ */
+void FFTSpectrum::setOutputs(int outputs)
 {
-    m_buffer = new AudioRingBuffer(getFormat(), (qint64)m_fftWorker->getFFTSize(), this);
+    m_fftWorker->setOutputs(outputs);
 }
 
-void FFTSpectrum::unregistered()
+int FFTSpectrum::getOutputs() const
 {
-    delete m_buffer;
+    return m_fftWorker->getOutputs();
 }
 
-void FFTSpectrum::audioDataReady(const QVector<double>& data)
+/**
+ * @brief Restricts the spectrum to the span around the center frequency, a span of 0 shows
+ * the full band again
+ */
+void FFTSpectrum::setZoom(double centerFrq, double span)
 {
-    if (m_buffer) {
-        //m_buffer->writeData(data);
-    }
+    m_fftWorker->setZoom(centerFrq, span);
 }
 
-void FFTSpectrum::compute()
+/**
+ * @brief Returns the band power index of the latest frame, which may be queried from any
+ * thread while the spectrum exists. It is updated if OUTPUT_BAND_POWER is selected.
+ */
+const BandPower* FFTSpectrum::getBandPower() const
 {
-    if (m_fftWorker && m_buffer->getBufferLength() >= m_fftSize) {
-        // TODO: avoid copying the buffer multiple times
-        QVector<double> bufferData;
-        m_buffer->getBuffer(bufferData);
+    return m_fftWorker->getBandPower();
+}
 
-        m_fftWorker->startFFT(getFormat(), bufferData);
-    }
+void FFTSpectrum::registered()
+{
+    m_fftWorker->setSampleRate(getFormat().sampleRate());
+}
+
+void FFTSpectrum::unregistered()
+{
+}
+
+void FFTSpectrum::processAudio(const QVector<double>& data)
+{
+    // the worker takes its frames directly from this stream
+    m_fftWorker->writeData(data);
 }
 
 void FFTSpectrum::spectrumReady()
 {
-    m_spectrumLog = m_fftWorker->getSpectrumLog();
-    m_spectrumMag = m_fftWorker->getSpectrumMag();
+    // several notifications may arrive for a single frame if frames have been skipped
+    if (!m_fftWorker->acquireFrame())
+        return;
+
+    const int outputs = m_fftWorker->getFrameOutputs();
+
+    if (m_fftWorker->isZoomFrame()) {
+        const double firstFrq = m_fftWorker->getFrameFrq();
+        const double binSize = m_fftWorker->getFrameBinSize();
+        if (outputs & OUTPUT_LOG)
+            emit zoomSpectrumLog(m_fftWorker->getSpectrumLog(), firstFrq, binSize);
+        if (outputs & OUTPUT_MAGNITUDE)
+            emit zoomSpectrumMag(m_fftWorker->getSpectrumMag(), firstFrq, binSize);
+        return;
+    }
 
     double binSize = getBinSize();
     double maxFrq = getMaxFrq();
 
-    emit spectrumLog(m_spectrumLog, binSize, maxFrq);
-    emit spectrumMag(m_spectrumMag, binSize, maxFrq);
+    // the vectors stay valid until the next frame is acquired, receivers that keep them
+    // share the data instead of copying it
+    if (outputs & OUTPUT_LOG)
+        emit spectrumLog(m_fftWorker->getSpectrumLog(), binSize, maxFrq);
+    if (outputs & OUTPUT_MAGNITUDE)
+        emit spectrumMag(m_fftWorker->getSpectrumMag(), binSize, maxFrq);
 }
 
 int FFTSpectrum::getFFTSize() const
@@ -110,6 +149,17 @@ int FFTSpectrum::getFFTSize() const
     return m_fftWorker ? m_fftWorker->getFFTSize() : 0;
 }
 
+int FFTSpectrum::getHopSize() const
+{
+    return m_fftWorker ? m_fftWorker->getHopSize() : 0;
+}
+
+double FFTSpectrum::getFrameRate() const
+{
+    const int hopSize = getHopSize();
+    return hopSize > 0 ? getFormat().sampleRate() / (double)hopSize : 0;
+}
+
 int FFTSpectrum::getSpectrumSize() const
 {
     return m_fftWorker ? m_fftWorker->getSpectrumSize() : 0;
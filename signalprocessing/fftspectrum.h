@@ -26,7 +26,6 @@
 #define FFTSPECTRUM_H
 
 #include "../audio/audioconsumer.h"
-#include "../audio/audioringbuffer.h"
 
 #include <QObject>
 #include <QAudioFormat>
@@ -47,45 +46,67 @@ enum FFTWindow {
     WT_BLACKMANHARRIS,
 };
 
+// spectrum representations, only the requested ones are computed for each frame
+enum FFTOutput {
+    OUTPUT_COMPLEX = 0x1,
+    OUTPUT_MAGNITUDE = 0x2,     // squared magnitude
+    OUTPUT_LOG = 0x4,           // squared magnitude in dB
+    OUTPUT_PHASE = 0x8,         // computed when it is read
+    OUTPUT_BAND_POWER = 0x10    // band power index, see getBandPower()
+};
+
 class FFTSpectrumWorker;
+class BandPower;
 
+/**
+ * @brief The FFTSpectrum class computes a short-time FFT of the input audio. A spectrum of
+ * fftSize samples is emitted every hopSize samples, so the frame rate is the sample rate
+ * divided by the hop size. The transforms run in a separate thread that is woken up by
+ * incoming audio.
+ *
+ * In zoom mode the spectrum covers only a span around a center frequency, e.g. the modem
+ * frequency, with the same number of bins. It is emitted by the zoom signals instead, which
+ * carry the frequency of the first bin and the bin size.
+ */
 class FFTSpectrum
         : public AudioConsumer
 {
     Q_OBJECT
 
 public:
-    FFTSpectrum(int, FFTWindow, QObject*);
+    FFTSpectrum(int fftSize, int hopSize, FFTWindow, QObject*);
     ~FFTSpectrum();
 
     void init();
+    void setOutputs(int outputs);
+    int getOutputs() const;
+    void setZoom(double centerFrq, double span);
+    const BandPower* getBandPower() const;
     int getFFTSize() const;
+    int getHopSize() const;
+    double getFrameRate() const;
     int getSpectrumSize() const;
     double getBinSize() const;
     double getMaxFrq() const;
 
-public slots:
-    void compute();
-
 private slots:
     void spectrumReady();
 
 signals:
     void spectrumLog(const QVector<double>&, double, double);
     void spectrumMag(const QVector<double>&, double, double);
+    void zoomSpectrumLog(const QVector<double>&, double, double);
+    void zoomSpectrumMag(const QVector<double>&, double, double);
 
 protected:
     void registered();
     void unregistered();
-    void audioDataReady(const QVector<double>& data);
+    void processAudio(const QVector<double>& data);
 
 private:
     int m_fftSize;
-    QVector<double> m_spectrumLog;
-    QVector<double> m_spectrumMag;
     FFTSpectrumWorker* m_fftWorker;
     QThread* m_fftThread;
-    AudioRingBuffer* m_buffer;
 };
 
 } // namespace Internal
@@ -24,9 +24,10 @@
 
 #include "fftspectrumworker.h"
 #include "fftspectrum.h"
+#include "fftplancache.h"
 #include "../audio/audiodevice.h"
 #include <math.h>
-#include <fftw/fftw3.h>
+#include <algorithm>
 
 #include <QtMath>
 #include <QtNumeric>
@@ -36,13 +37,69 @@
 
 using namespace Digital::Internal;
 
-FFTSpectrumWorker::FFTSpectrumWorker(int fftSize, FFTWindow windowFunc)
+const int FFTSpectrumWorker::MAX_BACKLOG = 4;
+
+// 10 * log10(x) = 10 * log10(2) * log2(x)
+static const double DB_PER_OCTAVE = 3.0102999566398120;
+
+/**
+ * @brief Squared magnitudes of count bins, written out on the interleaved parts so the
+ * compiler can vectorize it
+ */
+static void computeMagnitudes(const FFTComplex* in, double* out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = in[i][0] * in[i][0] + in[i][1] * in[i][1];
+}
+
+/**
+ * @brief 10 * log10(x) for count positive values, accurate to better than 1e-6 dB. The binary
+ * exponent is taken from the bits of x and the logarithm of the mantissa, moved to
+ * [sqrt(1/2), sqrt(2)), from the series of atanh. Zero gives a large negative value instead
+ * of -inf.
+ */
+static void computeDecibels(const double* in, double* out, int count)
+{
+    for (int i = 0; i < count; i++) {
+        quint64 bits;
+        memcpy(&bits, &in[i], sizeof(bits));
+        double exponent = (double)(int)((bits >> 52) & 0x7ff) - 1023.0;
+        bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+        double mantissa;
+        memcpy(&mantissa, &bits, sizeof(mantissa));
+
+        const bool upper = mantissa > M_SQRT2;
+        mantissa = upper ? 0.5 * mantissa : mantissa;
+        exponent = upper ? exponent + 1.0 : exponent;
+
+        // log2(m) = 2 / ln(2) * atanh((m - 1) / (m + 1)), |t| < 0.172
+        const double t = (mantissa - 1.0) / (mantissa + 1.0);
+        const double t2 = t * t;
+        const double series = t * (1.0 + t2 * (1.0 / 3 + t2 * (1.0 / 5 + t2 * (1.0 / 7))));
+        out[i] = DB_PER_OCTAVE * (exponent + 2.0 / M_LN2 * series);
+    }
+}
+
+FFTSpectrumWorker::FFTSpectrumWorker(int fftSize, int hopSize, FFTWindow windowFunc)
     : m_sampleRate(-1),
       m_window(0),
       m_terminate(false),
-      m_windowAvg(0)
+      m_windowAvg(0),
+      m_outputs(OUTPUT_MAGNITUDE | OUTPUT_LOG),
+      m_backFrame(2),
+      m_pending(1),
+      m_frontFrame(0),
+      m_frameCount(0),
+      m_zoomCenter(0),
+      m_zoomSpan(0),
+      m_zoomChanged(false),
+      m_zoomFilter(0),
+      m_zoomFilterSpan(0),
+      m_zoomHopSize(1),
+      m_zoomFiltered(0)
 {
     m_fftSize = fftSize;
+    m_hopSize = qBound(1, hopSize, fftSize);
     m_specSize = (m_fftSize / 2) + 1;
     m_binSize = 0;
     m_maxFrq = 0;
@@ -52,18 +109,21 @@ FFTSpectrumWorker::FFTSpectrumWorker(int fftSize, FFTWindow windowFunc)
     m_window = new double[m_fftSize];
     createWindow();
 
-    m_spectrum.resize(m_specSize);
-    m_spectrumMag.resize(m_specSize);
-    m_spectrumLog.resize(m_specSize);
-    m_spectrumPhase.resize(m_specSize);
+    for (int i = 0; i < 3; i++)
+        m_frames[i].resize(m_specSize);
+
+    // room for the frames of the backlog and the samples that arrive while they are computed
+    m_bufferIn.resize(2 * m_fftSize + MAX_BACKLOG * m_hopSize);
+    m_wakeThreshold.storeRelease(m_fftSize);
 
-    qDebug() << "using FFT size: " << m_fftSize;
+    qDebug() << "using FFT size: " << m_fftSize << "hop size: " << m_hopSize;
 }
 
 FFTSpectrumWorker::~FFTSpectrumWorker()
 {
     stop();
     delete[] m_window;
+    delete m_zoomFilter;
 }
 
 void FFTSpectrumWorker::stop()
@@ -74,121 +134,345 @@ void FFTSpectrumWorker::stop()
     m_mutexIn.unlock();
 }
 
-void FFTSpectrumWorker::startFFT(const QAudioFormat& format, const QVector<double>& buffer)
+void FFTSpectrumWorker::setSampleRate(int sampleRate)
 {
-    // set data
-    m_mutexIn.lock();
-    m_bufferIn = buffer;
-    m_mutexIn.unlock();
+    if (m_sampleRate == sampleRate)
+        return;
 
-    if (m_sampleRate != format.sampleRate()) {
-        m_sampleRate = format.sampleRate();
-        m_binSize = (m_sampleRate / 2.0) / m_specSize;
-        m_maxFrq = m_sampleRate / 2.0;
-
-        // resize output vectors if passband changed
-        const int bins = m_specSize;
-        if (m_spectrum.size() != bins)
-            m_spectrum.resize(bins);
-        if (m_spectrumMag.size() != bins)
-            m_spectrumMag.resize(bins);
-        if (m_spectrumLog.size() != bins)
-            m_spectrumLog.resize(bins);
-        if (m_spectrumPhase.size() != bins)
-            m_spectrumPhase.resize(bins);
-    }
+    m_sampleRate = sampleRate;
+    m_binSize = (double)m_sampleRate / m_fftSize;
+    m_maxFrq = m_sampleRate / 2.0;
+}
 
-    // wake thread to process next FFT
-    m_dataReady.wakeAll();
+/**
+ * @brief Selects the representations computed for each frame, a combination of FFTOutput
+ * flags. The phase needs the complex spectrum, which is kept as well.
+ */
+void FFTSpectrumWorker::setOutputs(int outputs)
+{
+    if (outputs & OUTPUT_PHASE)
+        outputs |= OUTPUT_COMPLEX;
+    if (!(outputs & OUTPUT_BAND_POWER))
+        m_bandPower.clear();
+    m_outputs.storeRelease(outputs);
 }
 
-void FFTSpectrumWorker::run()
+int FFTSpectrumWorker::getOutputs() const
 {
-    m_terminate = false;
+    return m_outputs.loadAcquire();
+}
 
-    // create an fftw plan for real-2-complex fft
-    double* in = (double*)fftw_malloc(sizeof(double) * m_fftSize);
-    fftw_complex* out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * m_fftSize);
-    fftw_plan my_plan = fftw_plan_dft_r2c_1d(m_fftSize, in, out, FFTW_ESTIMATE);
+/**
+ * @brief Zooms into the band of the given span around the center frequency, a span of 0
+ * returns to the full band. The worker thread applies the change with the next samples.
+ */
+void FFTSpectrumWorker::setZoom(double centerFrq, double span)
+{
+    QMutexLocker lock(&m_zoomMutex);
+    m_zoomCenter = centerFrq;
+    m_zoomSpan = qMax(0.0, span);
+    m_zoomChanged = true;
+}
 
-    while (!m_terminate) {
-        // wait for incoming data to process
+/**
+ * @brief Appends samples to the stream, called by the single producer. Samples that do not
+ * fit are dropped, the worker skips ahead anyway when it falls behind.
+ */
+void FFTSpectrumWorker::writeData(const QVector<double>& data)
+{
+    m_bufferIn.write(data.constData(), data.size());
+
+    // wake the thread only for complete frames, the mutex makes sure the wakeup is not lost
+    // between its check and its wait
+    if (m_bufferIn.getReadAvailable() >= m_wakeThreshold.loadAcquire()) {
         m_mutexIn.lock();
-        while (m_bufferIn.isEmpty() && !m_terminate)
-            m_dataReady.wait(&m_mutexIn);
+        m_dataReady.wakeAll();
         m_mutexIn.unlock();
+    }
+}
 
-        if (!m_terminate) {
-
-            //time.start();
-
-            // latency means that only a portion of the input data is processed via fft.
-            // a latency of 16 processes the whole input data of size m_fftSize while a
-            // latency of 1 processes the first 1/16th of input data.
-            double vscale = 2.0 / m_fftSize;
-            int latency = 16;
-            if (latency < 1)
-                latency = 1;
-            if (latency > 16)
-                latency = 16;
-            int nSamples = m_fftSize * latency / 16;
-            vscale *= sqrt(16.0 / latency);
-
-            // set input data
-            m_mutexIn.lock();
-            memset(in, 0, m_fftSize * sizeof(double));
-            for (int i = 0; i < nSamples; i++)
-                in[i] = m_window[i * 16 / latency] * m_bufferIn[i] * vscale;
-            m_bufferIn.clear();
-            m_mutexIn.unlock();
+void FFTSpectrumWorker::run()
+{
+    m_terminate = false;
 
-            // compute fft
-            fftw_execute(my_plan);
+    // buffers for the real-2-complex fft, the plan is taken from the shared plan cache
+    double* in = (double*)FFT::allocate(sizeof(double) * m_fftSize);
+    FFTComplex* out = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_fftSize);
+    FFTComplex* zoomIn = (FFTComplex*)FFT::allocate(sizeof(FFTComplex) * m_fftSize);
 
-            // lock to save output data
-            m_mutexOut.lock();
-            m_isOutputReady = false;
+    while (!m_terminate) {
+        updateZoom();
 
-            // get spectrum
-            for (int i = 0; i < m_specSize; i++) {
-                std::complex<double> value(out[i][0], out[i][1]);
+        // wait for a complete frame
+        m_mutexIn.lock();
+        while (m_bufferIn.getReadAvailable() < m_wakeThreshold.loadAcquire() && !m_terminate)
+            m_dataReady.wait(&m_mutexIn);
 
-                double mag = getMagnitude(value);
-                //double log = round(10.0 * log10(mag + 1e-10));
-                double log = 10.0 * log10(mag);
-                double phase = qAtan2(value.imag(), value.real());
+        if (m_zoomFilter) {
+            m_mutexIn.unlock();
+            processZoom(in, zoomIn, out);
+            continue;
+        }
 
-                m_spectrum[i] = value;
-                m_spectrumMag[i] = mag;
-                m_spectrumLog[i] = log;
-                m_spectrumPhase[i] = phase;
-            }
+        // skip the oldest samples if the backlog has grown too large
+        const qint64 maxAvailable = m_fftSize + (MAX_BACKLOG - 1) * m_hopSize;
+        const qint64 available = m_bufferIn.getReadAvailable();
+        if (available > maxAvailable)
+            m_bufferIn.commitRead(available - maxAvailable);
+        m_mutexIn.unlock();
 
-            m_isOutputReady = true;
-            m_mutexOut.unlock();
-            m_outputReady.wakeAll();
+        while (!m_terminate && m_bufferIn.getReadAvailable() >= m_fftSize) {
+            computeFrame(in, out);
+            m_bufferIn.commitRead(m_hopSize);
 
             // signal that data is ready
             emit dataReady();
         }
     }
 
-    fftw_destroy_plan(my_plan);
-    fftw_free(in);
-    fftw_free(out);
+    FFT::release(in);
+    FFT::release(out);
+    FFT::release(zoomIn);
 
     // signal that thread is finished
     emit finished();
 }
 
+/**
+ * @brief Transforms and publishes the oldest frame in the ring buffer
+ */
+void FFTSpectrumWorker::computeFrame(double* in, FFTComplex* out)
+{
+    transformFrame(in, out);
+    publishFrame(out, m_specSize, false, 0, m_binSize);
+}
+
+/**
+ * @brief Transforms the oldest frame in the ring buffer without publishing it, only the band
+ * power is updated. Used in zoom mode, so the band power does not depend on the zoom.
+ */
+void FFTSpectrumWorker::updateBandPower(double* in, FFTComplex* out)
+{
+    transformFrame(in, out);
+    m_bandPowerMag.resize(m_specSize);
+    computeMagnitudes(out, m_bandPowerMag.data(), m_specSize);
+    m_bandPower.update(m_bandPowerMag.constData(), m_specSize, 0, m_binSize, m_frameCount++);
+}
+
+/**
+ * @brief Transforms the oldest frame in the ring buffer into out. The window is applied while
+ * the samples are taken from the ring, so there is no intermediate copy.
+ */
+void FFTSpectrumWorker::transformFrame(double* in, FFTComplex* out)
+{
+    const double vscale = 2.0 / m_fftSize;
+
+    const double* first;
+    const double* second;
+    qint64 firstSize, secondSize;
+    m_bufferIn.getReadSpans(first, firstSize, second, secondSize);
+
+    const int n = (int)qMin<qint64>(firstSize, m_fftSize);
+    for (int i = 0; i < n; i++)
+        in[i] = m_window[i] * first[i] * vscale;
+    for (int i = n; i < m_fftSize; i++)
+        in[i] = m_window[i] * second[i - n] * vscale;
+
+    // compute fft, the cached plan may have been replaced by a measured one
+    const FFT* plan = FFTPlanCache::instance().getPlan(FFT::TYPE_REAL, m_fftSize);
+    plan->execute(in, out);
+}
+
+/**
+ * @brief Fills the back frame with the requested representations of count bins and
+ * publishes it. The band power is only taken from full band frames.
+ */
+void FFTSpectrumWorker::publishFrame(const FFTComplex* out, int count, bool zoom, double frq,
+                                     double binSize)
+{
+    Frame& frame = m_frames[m_backFrame];
+    if (frame.spectrumMag.size() != count)
+        frame.resize(count);
+
+    frame.number = m_frameCount++;
+    frame.outputs = m_outputs.loadAcquire();
+    frame.isPhaseValid = false;
+    frame.isZoom = zoom;
+    frame.frq = frq;
+    frame.binSize = binSize;
+
+    if (frame.outputs & OUTPUT_COMPLEX) {
+        const std::complex<double>* spectrum = reinterpret_cast<const std::complex<double>*>(out);
+        std::copy(spectrum, spectrum + count, frame.spectrum.begin());
+    }
+    const bool bandPower = (frame.outputs & OUTPUT_BAND_POWER) && !zoom;
+    if ((frame.outputs & (OUTPUT_MAGNITUDE | OUTPUT_LOG)) || bandPower)
+        computeMagnitudes(out, frame.spectrumMag.data(), count);
+    if (frame.outputs & OUTPUT_LOG)
+        computeDecibels(frame.spectrumMag.constData(), frame.spectrumLog.data(), count);
+    if (bandPower)
+        m_bandPower.update(frame.spectrumMag.constData(), count, frq, binSize, frame.number);
+
+    // publish the frame and continue with the one the reader has not taken, if any
+    m_backFrame = m_pending.fetchAndStoreOrdered(m_backFrame | FRAME_NEW) & FRAME_INDEX;
+}
+
+/**
+ * @brief Applies a changed zoom setting. The lowpass of the zoom filter is half the span
+ * wide and the output rate the lowest power of two fraction of the sample rate that is at
+ * least one and a half times the span, so the transition band does not alias into the span.
+ */
+void FFTSpectrumWorker::updateZoom()
+{
+    QMutexLocker lock(&m_zoomMutex);
+    if (!m_zoomChanged || m_sampleRate <= 0)
+        return;
+    m_zoomChanged = false;
+
+    const double center = m_zoomCenter;
+    const double span = qMin(m_zoomSpan, m_sampleRate / 2.0);
+    lock.unlock();
+
+    if (span <= 0) {
+        delete m_zoomFilter;
+        m_zoomFilter = 0;
+        m_zoomSamples.clear();
+        m_zoomFiltered = 0;
+        m_wakeThreshold.storeRelease(m_fftSize);
+        return;
+    }
+
+    // a blackman windowed sinc has a transition band of about 5.5 / taps
+    int filterLength = 1024;
+    while (filterLength < 65536 && filterLength / 2 < 22.0 * m_sampleRate / span)
+        filterLength *= 2;
+
+    int decimation = 1;
+    while (m_sampleRate / (2.0 * decimation) >= 1.5 * span)
+        decimation *= 2;
+
+    if (!m_zoomFilter || span != m_zoomFilterSpan || m_zoomFilter->getSampleRate() != m_sampleRate) {
+        delete m_zoomFilter;
+        m_zoomFilter = new FFTFilterBank(m_sampleRate, filterLength);
+        m_zoomFilter->createLPF(span / 2.0);
+        m_zoomFilter->setChannels(1);
+        m_zoomFilter->setDecimation(decimation);
+        m_zoomFilterSpan = span;
+        m_zoomSamples.clear();
+    }
+    m_zoomFilter->setChannelFrequency(0, center);
+
+    // frames keep the rate of the full band spectrum
+    m_zoomHopSize = qMax(1, m_hopSize / m_zoomFilter->getDecimation());
+    m_wakeThreshold.storeRelease(m_zoomFiltered + getZoomWakeStep());
+}
+
+/**
+ * @brief Returns the number of new input samples that make a zoom hop
+ */
+int FFTSpectrumWorker::getZoomWakeStep() const
+{
+    return qMin(m_zoomHopSize * m_zoomFilter->getDecimation(), m_fftSize);
+}
+
+/**
+ * @brief Mixes, filters and decimates all new buffered input and transforms the complete
+ * frames. While the band power is requested, the input is kept for the full band frames it
+ * is computed from, the zoom filter skips the samples it has already seen.
+ */
+void FFTSpectrumWorker::processZoom(double* in, FFTComplex* zoomIn, FFTComplex* out)
+{
+    const double* spans[2];
+    qint64 sizes[2];
+    qint64 available = m_bufferIn.getReadSpans(spans[0], sizes[0], spans[1], sizes[1]);
+
+    qint64 skip = qMin(m_zoomFiltered, available);
+    for (int i = 0; i < 2; i++) {
+        const qint64 skipped = qMin(skip, sizes[i]);
+        skip -= skipped;
+        const int count = (int)(sizes[i] - skipped);
+        if (count == 0)
+            continue;
+
+        // the filter writes directly behind the samples that are still pending
+        const int pending = m_zoomSamples.size();
+        m_zoomSamples.resize(pending + m_zoomFilter->getMaxOutput(count));
+
+        std::complex<double>* output = m_zoomSamples.data() + pending;
+        m_zoomSamples.resize(pending + m_zoomFilter->run(spans[i] + skipped, count, &output));
+    }
+
+    if (m_outputs.loadAcquire() & OUTPUT_BAND_POWER) {
+        const qint64 maxAvailable = m_fftSize + (MAX_BACKLOG - 1) * m_hopSize;
+        if (available > maxAvailable) {
+            m_bufferIn.commitRead(available - maxAvailable);
+            available = maxAvailable;
+        }
+        while (!m_terminate && available >= m_fftSize) {
+            updateBandPower(in, out);
+            m_bufferIn.commitRead(m_hopSize);
+            available -= m_hopSize;
+        }
+    } else {
+        m_bufferIn.commitRead(available);
+        available = 0;
+    }
+
+    // wake up again for new input only
+    m_zoomFiltered = available;
+    m_wakeThreshold.storeRelease(m_zoomFiltered + getZoomWakeStep());
+
+    // skip the oldest samples if the backlog has grown too large
+    const int maxSamples = m_fftSize + (MAX_BACKLOG - 1) * m_zoomHopSize;
+    if (m_zoomSamples.size() > maxSamples)
+        m_zoomSamples.remove(0, m_zoomSamples.size() - maxSamples);
+
+    while (!m_terminate && m_zoomSamples.size() >= m_fftSize) {
+        computeZoomFrame(zoomIn, out);
+        m_zoomSamples.remove(0, qMin(m_zoomHopSize, m_zoomSamples.size()));
+
+        emit dataReady();
+    }
+}
+
+/**
+ * @brief Transforms the oldest fftSize decimated samples. Alternating the sign of the input
+ * moves the center frequency to the middle bin.
+ */
+void FFTSpectrumWorker::computeZoomFrame(FFTComplex* in, FFTComplex* out)
+{
+    // the filter has the gain of its length, the real input had half the amplitude in the
+    // complex baseband
+    const double vscale = 2.0 / m_fftSize / m_zoomFilter->getLength();
+
+    const std::complex<double>* samples = m_zoomSamples.constData();
+    for (int i = 0; i < m_fftSize; i++) {
+        const double scale = (i & 1) ? -vscale * m_window[i] : vscale * m_window[i];
+        in[i][0] = samples[i].real() * scale;
+        in[i][1] = samples[i].imag() * scale;
+    }
+
+    const FFT* plan = FFTPlanCache::instance().getPlan(FFT::TYPE_FORWARD, m_fftSize);
+    plan->execute(in, out);
+
+    const double rate = m_zoomFilter->getOutputRate();
+    const double binSize = rate / m_fftSize;
+    publishFrame(out, m_fftSize, true, m_zoomFilter->getChannelFrequency(0) - rate / 2.0, binSize);
+}
+
 int FFTSpectrumWorker::getFFTSize() const
 {
     return m_fftSize;
 }
 
+int FFTSpectrumWorker::getHopSize() const
+{
+    return m_hopSize;
+}
+
 int FFTSpectrumWorker::getSpectrumSize() const
 {
-    return m_spectrum.size();
+    return m_specSize;
 }
 
 double FFTSpectrumWorker::getBinSize() const
@@ -201,48 +485,98 @@ double FFTSpectrumWorker::getMaxFrq() const
     return m_maxFrq;
 }
 
-const QVector<std::complex<double> >& FFTSpectrumWorker::getSpectrum()
+/**
+ * @brief Makes the newest published frame the current one of the reader. The spectra of the
+ * previous frame must not be used anymore.
+ * @return false if there is no frame newer than the current one
+ */
+bool FFTSpectrumWorker::acquireFrame()
+{
+    if (!(m_pending.loadAcquire() & FRAME_NEW))
+        return false;
+
+    m_frontFrame = m_pending.fetchAndStoreOrdered(m_frontFrame) & FRAME_INDEX;
+    return true;
+}
+
+/**
+ * @brief Returns the running number of the current frame, -1 if there is none yet. Gaps
+ * show frames that have been replaced before the reader acquired them, or that only updated
+ * the band power in zoom mode.
+ */
+qint64 FFTSpectrumWorker::getFrameNumber() const
+{
+    return m_frames[m_frontFrame].number;
+}
+
+/**
+ * @brief Returns the FFTOutput flags the current frame has been computed with
+ */
+int FFTSpectrumWorker::getFrameOutputs() const
+{
+    return m_frames[m_frontFrame].outputs;
+}
+
+bool FFTSpectrumWorker::isZoomFrame() const
 {
-    // wait until data is ready
-    m_mutexOut.lock();
-    while (!m_isOutputReady)
-        m_outputReady.wait(&m_mutexOut);
-    m_mutexOut.unlock();
+    return m_frames[m_frontFrame].isZoom;
+}
 
-    return m_spectrum;
+/**
+ * @brief Returns the frequency of the first bin of the current frame
+ */
+double FFTSpectrumWorker::getFrameFrq() const
+{
+    return m_frames[m_frontFrame].frq;
+}
+
+double FFTSpectrumWorker::getFrameBinSize() const
+{
+    return m_frames[m_frontFrame].binSize;
 }
 
-const QVector<double>& FFTSpectrumWorker::getSpectrumMag()
+/**
+ * @brief Returns the band power index, unlike the frame getters it may be used by any thread
+ */
+const BandPower* FFTSpectrumWorker::getBandPower() const
 {
-    // wait until data is ready
-    m_mutexOut.lock();
-    while (!m_isOutputReady)
-        m_outputReady.wait(&m_mutexOut);
-    m_mutexOut.unlock();
+    return &m_bandPower;
+}
 
-    return m_spectrumMag;
+const QVector<std::complex<double> >& FFTSpectrumWorker::getSpectrum() const
+{
+    return m_frames[m_frontFrame].spectrum;
 }
 
-const QVector<double>& FFTSpectrumWorker::getSpectrumLog()
+const QVector<double>& FFTSpectrumWorker::getSpectrumMag() const
 {
-    // wait until data is ready
-    m_mutexOut.lock();
-    while (!m_isOutputReady)
-        m_outputReady.wait(&m_mutexOut);
-    m_mutexOut.unlock();
+    return m_frames[m_frontFrame].spectrumMag;
+}
 
-    return m_spectrumLog;
+const QVector<double>& FFTSpectrumWorker::getSpectrumLog() const
+{
+    return m_frames[m_frontFrame].spectrumLog;
 }
 
 const QVector<double>& FFTSpectrumWorker::getSpectrumPhase()
 {
-    // wait until data is ready
-    m_mutexOut.lock();
-    while (!m_isOutputReady)
-        m_outputReady.wait(&m_mutexOut);
-    m_mutexOut.unlock();
+    // the phase is rarely needed, it is only computed on request
+    Frame& frame = m_frames[m_frontFrame];
+    if (!frame.isPhaseValid && (frame.outputs & OUTPUT_PHASE)) {
+        for (int i = 0; i < frame.spectrum.size(); i++)
+            frame.spectrumPhase[i] = qAtan2(frame.spectrum[i].imag(), frame.spectrum[i].real());
+        frame.isPhaseValid = true;
+    }
+
+    return frame.spectrumPhase;
+}
 
-    return m_spectrumPhase;
+void FFTSpectrumWorker::Frame::resize(int bins)
+{
+    spectrum.resize(bins);
+    spectrumMag.resize(bins);
+    spectrumLog.resize(bins);
+    spectrumPhase.resize(bins);
 }
 
 void FFTSpectrumWorker::createWindow()
@@ -281,13 +615,3 @@ double FFTSpectrumWorker::calcWindowFunc(const int sample)
         return 0;
     }
 }
-
-double FFTSpectrumWorker::getMagnitude(const std::complex<double>& fftVal) const
-{
-    return std::norm(fftVal);
-}
-
-double FFTSpectrumWorker::getMagnitudeSqr(const std::complex<double>& fftVal) const
-{
-    return fftVal.real() * fftVal.real() + fftVal.imag() * fftVal.imag();
-}
@@ -30,8 +30,13 @@
 #include <QVector>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicInt>
 #include <complex>
 #include "fftspectrum.h"
+#include "../audio/lockfreeringbuffer.h"
+#include "fftbackend.h"
+#include "fftfilterbank.h"
+#include "bandpower.h"
 
 namespace Digital {
 namespace Internal {
@@ -39,28 +44,56 @@ namespace Internal {
 // threading method (not subclassing QThread) discussed in
 // http://mayaposch.wordpress.com/2011/11/01/how-to-really-truly-use-qthreads-the-full-explanation/
 // http://blog.qt.digia.com/blog/2010/06/17/youre-doing-it-wrong/
+// The worker computes a short-time FFT of the stream written with writeData(). It wakes up
+// whenever a complete frame is available and transforms all frames that are hopSize samples
+// apart directly out of the ring buffer. If it falls behind by more than MAX_BACKLOG frames,
+// the oldest samples are skipped, so the CPU load is bounded by the frame rate.
+//
+// Finished frames are published through a triple buffer: the worker fills the back frame and
+// swaps it with the pending one, the reader swaps its front frame with the pending one if that
+// is newer. Neither side waits or copies, but there may only be a single reader thread.
+//
+// In zoom mode the input is mixed down from a center frequency, lowpass filtered and decimated
+// to a little more than the span, and frames of fftSize complex samples are transformed. This
+// resolves the span with fftSize bins at a fraction of the cost of a full-band transform with
+// the same resolution.
 class FFTSpectrumWorker
         : public QObject
 {
     Q_OBJECT
 
 public:
-    FFTSpectrumWorker(int, FFTWindow);
+    FFTSpectrumWorker(int fftSize, int hopSize, FFTWindow);
     ~FFTSpectrumWorker();
 
     void stop();
 
+    void setSampleRate(int);
+    void setOutputs(int);
+    int getOutputs() const;
+    void setZoom(double centerFrq, double span);
+    void writeData(const QVector<double>&);
+
     int getFFTSize() const;
+    int getHopSize() const;
     int getSpectrumSize() const;
     double getBinSize() const;
     double getMaxFrq() const;
-    const QVector<std::complex<double> >& getSpectrum();
-    const QVector<double>& getSpectrumMag();
-    const QVector<double>& getSpectrumLog();
+
+    // reader side, the spectra belong to the frame taken by the last acquireFrame()
+    bool acquireFrame();
+    qint64 getFrameNumber() const;
+    int getFrameOutputs() const;
+    bool isZoomFrame() const;
+    double getFrameFrq() const;
+    double getFrameBinSize() const;
+    const BandPower* getBandPower() const;
+    const QVector<std::complex<double> >& getSpectrum() const;
+    const QVector<double>& getSpectrumMag() const;
+    const QVector<double>& getSpectrumLog() const;
     const QVector<double>& getSpectrumPhase();
 
 public slots:
-    void startFFT(const QAudioFormat&, const QVector<double>&);
     void run();
 
 signals:
@@ -69,11 +102,40 @@ signals:
 
 private:
     void createWindow();
+    void computeFrame(double* in, FFTComplex* out);
+    void updateBandPower(double* in, FFTComplex* out);
+    void transformFrame(double* in, FFTComplex* out);
+    void publishFrame(const FFTComplex* out, int count, bool zoom, double frq, double binSize);
+    void updateZoom();
+    int getZoomWakeStep() const;
+    void processZoom(double* in, FFTComplex* zoomIn, FFTComplex* out);
+    void computeZoomFrame(FFTComplex* in, FFTComplex* out);
     double calcWindowFunc(const int);
-    double getMagnitude(const std::complex<double>&) const;
-    double getMagnitudeSqr(const std::complex<double>&) const;
+
+    static const int MAX_BACKLOG;
+
+    struct Frame {
+        Frame() : number(-1), outputs(0), isPhaseValid(false), isZoom(false), frq(0), binSize(0) {}
+        void resize(int bins);
+
+        qint64 number;                          // -1 if no spectrum has been computed yet
+        int outputs;                            // FFTOutput flags the frame was computed with
+        bool isPhaseValid;                      // the phase is computed when it is read
+        bool isZoom;
+        double frq;                             // frequency of the first bin
+        double binSize;
+        QVector<std::complex<double> > spectrum;    // complex spectrum
+        QVector<double> spectrumMag;            // magnitude spectrum
+        QVector<double> spectrumLog;            // logarithmic spectrum
+        QVector<double> spectrumPhase;          // spectrum's phase
+    };
+    enum {
+        FRAME_INDEX = 0x3,
+        FRAME_NEW = 0x4         // the pending frame has not been acquired yet
+    };
 
     int m_fftSize;
+    int m_hopSize;
     int m_specSize;
     int m_sampleRate;
     double m_binSize;
@@ -86,16 +148,29 @@ private:
     QMutex m_mutexIn;
     QWaitCondition m_dataReady;
 
-    QMutex m_mutexOut;
-    QWaitCondition m_outputReady;
-    bool m_isOutputReady;
-
-    QVector<double> m_bufferIn;
-
-    QVector<std::complex<double> > m_spectrum;	// complex spectrum
-    QVector<double> m_spectrumMag;      // magnitude spectrum
-    QVector<double> m_spectrumLog;		// logarithmic spectrum
-    QVector<double> m_spectrumPhase;	// spectrum's phase
+    QAtomicInt m_outputs;   // FFTOutput flags, read once per frame
+    QAtomicInt m_wakeThreshold; // input samples that make a frame or the next zoom hop
+
+    LockFreeRingBuffer<double> m_bufferIn;
+
+    Frame m_frames[3];
+    int m_backFrame;        // written by the worker
+    QAtomicInt m_pending;   // index of the latest published frame and FRAME_NEW
+    int m_frontFrame;       // read by the reader
+    qint64 m_frameCount;
+    BandPower m_bandPower;  // prefix sums of the power of the latest full band frame
+    QVector<double> m_bandPowerMag; // magnitudes of full band frames in zoom mode
+
+    // zoom mode, the requested parameters are applied by the worker thread
+    QMutex m_zoomMutex;
+    double m_zoomCenter;
+    double m_zoomSpan;      // 0 if zoom is off
+    bool m_zoomChanged;
+    FFTFilterBank* m_zoomFilter;    // 0 if zoom is off
+    double m_zoomFilterSpan;        // span the filter was designed for
+    int m_zoomHopSize;      // in decimated samples
+    QVector<std::complex<double> > m_zoomSamples;   // decimated samples of the next frames
+    qint64 m_zoomFiltered;  // input samples in the ring already passed to the zoom filter
 };
 
 } // namespace Internal
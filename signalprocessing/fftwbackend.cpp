@@ -0,0 +1,128 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "fftwbackend.h"
+#include <QFile>
+#include <QtGlobal>
+#include <fftw/fftw3.h>
+
+namespace Digital {
+namespace Internal {
+
+class FFTWTransform
+        : public FFT
+{
+public:
+    FFTWTransform(Type type, int size, fftw_plan plan)
+        : FFT(type, size),
+          m_plan(plan)
+    {
+    }
+
+    ~FFTWTransform()
+    {
+        fftw_destroy_plan(m_plan);
+    }
+
+    // FFTW preserves the input of out-of-place complex and r2c transforms
+    void execute(const FFTComplex* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() != TYPE_REAL);
+        fftw_execute_dft(m_plan, const_cast<fftw_complex*>(in), out);
+    }
+
+    void execute(const double* in, FFTComplex* out) const
+    {
+        Q_ASSERT(getType() == TYPE_REAL);
+        fftw_execute_dft_r2c(m_plan, const_cast<double*>(in), out);
+    }
+
+private:
+    fftw_plan m_plan;
+};
+
+} // namespace Internal
+} // namespace Digital
+
+using namespace Digital::Internal;
+
+QString FFTWBackend::getNameStatic()
+{
+    return "fftw";
+}
+
+QString FFTWBackend::getName() const
+{
+    return getNameStatic();
+}
+
+FFT* FFTWBackend::createFFT(FFT::Type type, int size, Effort effort)
+{
+    unsigned flags = FFTW_ESTIMATE;
+    if (effort == EFFORT_MEASURE)
+        flags = FFTW_MEASURE;
+    else if (effort == EFFORT_PATIENT)
+        flags = FFTW_PATIENT;
+
+    // measuring overwrites the arrays, so plans are always created on scratch arrays. These
+    // are aligned to the SIMD boundary just like the arrays of FFT::allocate().
+    fftw_complex* in = fftw_alloc_complex(size);
+    fftw_complex* out = fftw_alloc_complex(size);
+
+    fftw_plan plan = 0;
+    switch (type) {
+    case FFT::TYPE_FORWARD:
+        plan = fftw_plan_dft_1d(size, in, out, FFTW_FORWARD, flags);
+        break;
+    case FFT::TYPE_BACKWARD:
+        plan = fftw_plan_dft_1d(size, in, out, FFTW_BACKWARD, flags);
+        break;
+    case FFT::TYPE_REAL:
+        plan = fftw_plan_dft_r2c_1d(size, (double*)in, out, flags);
+        break;
+    default:
+        break;
+    }
+
+    fftw_free(in);
+    fftw_free(out);
+
+    return plan ? new FFTWTransform(type, size, plan) : 0;
+}
+
+bool FFTWBackend::isTunable() const
+{
+    return true;
+}
+
+bool FFTWBackend::importWisdom(const QString& fileName)
+{
+    return fftw_import_wisdom_from_filename(QFile::encodeName(fileName).constData()) != 0;
+}
+
+bool FFTWBackend::exportWisdom(const QString& fileName)
+{
+    return fftw_export_wisdom_to_filename(QFile::encodeName(fileName).constData()) != 0;
+}
@@ -0,0 +1,55 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef FFTWBACKEND_H
+#define FFTWBACKEND_H
+
+#include "fftbackend.h"
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief FFT backend using the FFTW library. Transforms are FFTW plans executed with the
+ * new-array execute functions, the effort maps to the FFTW planner flags.
+ */
+class FFTWBackend
+        : public FFTBackend
+{
+public:
+    static QString getNameStatic();
+    QString getName() const;
+
+    FFT* createFFT(FFT::Type type, int size, Effort effort);
+    bool isTunable() const;
+
+    bool importWisdom(const QString& fileName);
+    bool exportWisdom(const QString& fileName);
+};
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // FFTWBACKEND_H
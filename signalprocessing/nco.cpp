@@ -0,0 +1,185 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#include "nco.h"
+#include <QtGlobal>
+#include <cmath>
+
+using namespace Digital::Internal;
+
+NCO::NCO(double sampleRate, double frequency)
+    : m_sampleRate(sampleRate),
+      m_frequency(frequency),
+      m_phasor(1.0, 0.0),
+      m_step(1.0, 0.0),
+      m_counter(0)
+{
+    updateStep();
+}
+
+void NCO::setSampleRate(double sampleRate)
+{
+    if (sampleRate != m_sampleRate) {
+        m_sampleRate = sampleRate;
+        updateStep();
+    }
+}
+
+/**
+ * @brief Sets the frequency in Hz. This is cheap if the frequency did not change, so it may be
+ * called for every block or sample.
+ */
+void NCO::setFrequency(double frequency)
+{
+    if (frequency != m_frequency) {
+        m_frequency = frequency;
+        updateStep();
+    }
+}
+
+double NCO::getSampleRate() const
+{
+    return m_sampleRate;
+}
+
+double NCO::getFrequency() const
+{
+    return m_frequency;
+}
+
+/**
+ * @brief Resets the phase to zero
+ */
+void NCO::reset()
+{
+    m_phasor = std::complex<double>(1.0, 0.0);
+    m_counter = 0;
+}
+
+double NCO::getPhase() const
+{
+    return std::arg(m_phasor);
+}
+
+void NCO::mixDown(const std::complex<double>* in, std::complex<double>* out, int count)
+{
+    // the inner loops do not renormalize, so they only contain the recurrence itself. The
+    // products are written out, std::complex multiplication calls a helper for the NaN cases.
+    const double stepRe = m_step.real();
+    const double stepIm = m_step.imag();
+    while (count > 0) {
+        const int len = qMin(count, RenormInterval - m_counter);
+        double re = m_phasor.real();
+        double im = m_phasor.imag();
+        for (int i = 0; i < len; i++) {
+            const double inRe = in[i].real();
+            const double inIm = in[i].imag();
+            out[i] = std::complex<double>(inRe * re + inIm * im, inIm * re - inRe * im);
+
+            const double next = re * stepRe - im * stepIm;
+            im = re * stepIm + im * stepRe;
+            re = next;
+        }
+
+        m_phasor = std::complex<double>(re, im);
+        m_counter += len;
+        if (m_counter >= RenormInterval)
+            renormalize();
+
+        in += len;
+        out += len;
+        count -= len;
+    }
+}
+
+/**
+ * @brief Shifts a block of real samples down by the oscillator frequency
+ */
+void NCO::mixDown(const double* in, std::complex<double>* out, int count)
+{
+    const double stepRe = m_step.real();
+    const double stepIm = m_step.imag();
+    while (count > 0) {
+        const int len = qMin(count, RenormInterval - m_counter);
+        double re = m_phasor.real();
+        double im = m_phasor.imag();
+        for (int i = 0; i < len; i++) {
+            out[i] = std::complex<double>(in[i] * re, -in[i] * im);
+
+            const double next = re * stepRe - im * stepIm;
+            im = re * stepIm + im * stepRe;
+            re = next;
+        }
+
+        m_phasor = std::complex<double>(re, im);
+        m_counter += len;
+        if (m_counter >= RenormInterval)
+            renormalize();
+
+        in += len;
+        out += len;
+        count -= len;
+    }
+}
+
+/**
+ * @brief Generates a block of sine samples, the same as calling nextSin() for each sample
+ */
+void NCO::generate(double* out, int count)
+{
+    const double stepRe = m_step.real();
+    const double stepIm = m_step.imag();
+    while (count > 0) {
+        const int len = qMin(count, RenormInterval - m_counter);
+        double re = m_phasor.real();
+        double im = m_phasor.imag();
+        for (int i = 0; i < len; i++) {
+            const double next = re * stepRe - im * stepIm;
+            im = re * stepIm + im * stepRe;
+            re = next;
+            out[i] = im;
+        }
+
+        m_phasor = std::complex<double>(re, im);
+        m_counter += len;
+        if (m_counter >= RenormInterval)
+            renormalize();
+
+        out += len;
+        count -= len;
+    }
+}
+
+void NCO::updateStep()
+{
+    const double delta = 2.0 * M_PI * m_frequency / m_sampleRate;
+    m_step = std::complex<double>(cos(delta), sin(delta));
+}
+
+void NCO::renormalize()
+{
+    m_phasor /= std::abs(m_phasor);
+    m_counter = 0;
+}
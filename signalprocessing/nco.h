@@ -0,0 +1,118 @@
+/***********************************************************************
+ *
+ * LISA: Lightweight Integrated System for Amateur Radio
+ * Copyright (C) 2013 - 2014
+ *      Norman Link (DM6LN)
+ *
+ * This file is part of LISA.
+ *
+ * LISA is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LISA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You can find a copy of the GNU General Public License in the file
+ * LICENSE.GPL contained in the root directory of this project or
+ * under <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************/
+
+
+#ifndef NCO_H
+#define NCO_H
+
+#include <complex>
+
+namespace Digital {
+namespace Internal {
+
+/**
+ * @brief The NCO class is a numerically controlled oscillator that generates exp(j*phi) with a
+ * complex phasor recurrence. Each sample costs one complex multiplication instead of a sin()
+ * and a cos() call. The magnitude of the phasor is renormalized in regular intervals so that
+ * rounding errors do not accumulate.
+ *
+ * Retuning only replaces the phase increment, the phase itself continues without a jump.
+ */
+class NCO
+{
+public:
+    NCO(double sampleRate = 8000.0, double frequency = 0.0);
+
+    void setSampleRate(double);
+    void setFrequency(double);
+    double getSampleRate() const;
+    double getFrequency() const;
+
+    void reset();
+    double getPhase() const;
+
+    inline std::complex<double> getPhasor() const;
+    inline void advance();
+    inline double nextSin();
+    inline std::complex<double> mixDown(const std::complex<double>& in);
+
+    void mixDown(const std::complex<double>* in, std::complex<double>* out, int count);
+    void mixDown(const double* in, std::complex<double>* out, int count);
+    void generate(double* out, int count);
+
+private:
+    enum { RenormInterval = 512 };
+
+    void updateStep();
+    void renormalize();
+
+    double m_sampleRate;
+    double m_frequency;
+    std::complex<double> m_phasor;
+    std::complex<double> m_step;
+    int m_counter;
+};
+
+std::complex<double> NCO::getPhasor() const
+{
+    return m_phasor;
+}
+
+/**
+ * @brief Advances the phase by one sample
+ */
+void NCO::advance()
+{
+    m_phasor = std::complex<double>(
+            m_phasor.real() * m_step.real() - m_phasor.imag() * m_step.imag(),
+            m_phasor.real() * m_step.imag() + m_phasor.imag() * m_step.real());
+    if (++m_counter >= RenormInterval)
+        renormalize();
+}
+
+/**
+ * @brief Advances the phase and returns the sine of the new phase
+ */
+double NCO::nextSin()
+{
+    advance();
+    return m_phasor.imag();
+}
+
+/**
+ * @brief Shifts a sample down by the oscillator frequency, i.e. multiplies it by exp(-j*phi),
+ * and advances the phase
+ */
+std::complex<double> NCO::mixDown(const std::complex<double>& in)
+{
+    std::complex<double> z(in.real() * m_phasor.real() + in.imag() * m_phasor.imag(),
+                           in.imag() * m_phasor.real() - in.real() * m_phasor.imag());
+    advance();
+    return z;
+}
+
+} // namespace Internal
+} // namespace Digital
+
+#endif // NCO_H